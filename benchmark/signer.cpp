@@ -0,0 +1,103 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Signatures per second of one Lnurl::Signer shared by 1..N threads (on hosts only).
+//
+//   $ make benchmark [THREADS=N]
+
+#include "lnurl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	// Each thread count is measured for this long.
+	const std::chrono::milliseconds duration(1000);
+
+	// Signs URLs with distinct nonces into a stack buffer until stop is set. Returns the number signed.
+	uint64_t sign_until(const Lnurl::Signer &signer, const Lnurl::WithdrawParams &params, unsigned int thread, const std::atomic<bool> &stop) {
+		char output[512];
+		char nonce[32];
+		uint64_t count = 0;
+		while (!stop.load(std::memory_order_relaxed)) {
+			const int length = snprintf(nonce, sizeof(nonce), "%u-%llu", thread, (unsigned long long)count);
+			size_t urlLength;
+			if (signer.create_url(output, urlLength, params, Lnurl::StringView(nonce, length)) != Lnurl::Status::Ok) {
+				fprintf(stderr, "Signing failed\n");
+				exit(1);
+			}
+			count++;
+		}
+		return count;
+	}
+}
+
+int main(int argc, char** argv) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	if (signer.set_config(config) != Lnurl::Status::Ok) {
+		return 1;
+	}
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	params.defaultDescription = "Benchmark";
+
+	unsigned int maxThreads = argc > 1 ? atoi(argv[1]) : 0;
+	if (maxThreads == 0) {
+		maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	printf("threads  signatures/s  speedup\n");
+	double single = 0;
+	for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+		std::atomic<bool> stop(false);
+		std::vector<uint64_t> counts(threads);
+		std::vector<std::thread> workers;
+		const auto start = std::chrono::steady_clock::now();
+		for (unsigned int t = 0; t < threads; t++) {
+			workers.emplace_back([&signer, &params, &stop, &counts, t]() {
+				counts[t] = sign_until(signer, params, t, stop);
+			});
+		}
+		std::this_thread::sleep_for(duration);
+		stop = true;
+		for (auto &worker : workers) {
+			worker.join();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		uint64_t total = 0;
+		for (const uint64_t count : counts) {
+			total += count;
+		}
+		const double rate = total / seconds;
+		if (threads == 1) {
+			single = rate;
+		}
+		printf("%7u  %12.0f  %6.2fx\n", threads, rate, rate / single);
+	}
+	return 0;
+}
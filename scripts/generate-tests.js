@@ -168,7 +168,8 @@ const replacements = {
 	config.apiKey.encoding = "${apiKey.encoding}";
 	config.callbackUrl = "${callbackUrl}";
 	config.shorten = ${shorten};
-	Lnurl::Signer signer(config);
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
 	const std::string nonce = "${nonce}";`;
 	SIGNER_TEST += `
 	Lnurl::WithdrawParams params;
@@ -184,7 +185,8 @@ const replacements = {
 	}
 	const signedUrl = lnurl.createSignedUrl(apiKey, tag, params, options);
 	SIGNER_TEST += `
-	const std::string result = signer.create_url(params, nonce);
+	std::string result;
+	TEST_ASSERT_TRUE(signer.create_url(result, params, nonce) == Lnurl::Status::Ok);
 	const std::string expected = "${signedUrl}";
 	TEST_ASSERT_EQUAL_STRING(
 		expected.c_str(),
@@ -0,0 +1,76 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LNURL_ARENA_H
+#define LNURL_ARENA_H
+
+#include "span.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Lnurl {
+
+	// Bump allocator over a caller-owned buffer, for the functions which take their scratch
+	// memory and results from it instead of the heap (e.g. Signer::create_url(arena, ...)).
+	// Allocating only moves an offset forward, and everything is freed at once by reset()
+	// (e.g. after each URL was sent), so memory use doesn't depend on heap fragmentation:
+	//
+	//   static uint8_t buffer[1024];
+	//   Lnurl::Arena arena(buffer);
+	//
+	// An arena isn't synchronized: threads each use their own (e.g. a thread_local one).
+	class Arena {
+		public:
+			Arena(Span<uint8_t> t_buffer) : buffer(t_buffer) {}
+			// Returns nullptr if there isn't room for size bytes at the given alignment (a power of two).
+			void* allocate(size_t size, size_t alignment = 1) {
+				const size_t padding = (0 - reinterpret_cast<uintptr_t>(buffer.data() + offset)) & (alignment - 1);
+				if (padding > buffer.size() - offset || size > buffer.size() - offset - padding) {
+					return nullptr;
+				}
+				void* const allocation = buffer.data() + offset + padding;
+				offset += padding + size;
+				return allocation;
+			}
+			// Room for count characters (or bytes), or nullptr.
+			char* allocate_chars(size_t count) {
+				return static_cast<char*>(allocate(count));
+			}
+			// Everything allocated after mark() was called is freed by rewind(mark).
+			size_t mark() const {
+				return offset;
+			}
+			void rewind(size_t t_mark) {
+				offset = t_mark < offset ? t_mark : offset;
+			}
+			void reset() {
+				offset = 0;
+			}
+			size_t used() const {
+				return offset;
+			}
+			size_t capacity() const {
+				return buffer.size();
+			}
+		private:
+			Span<uint8_t> buffer;
+			size_t offset = 0;
+	};
+}
+
+#endif
@@ -1,4 +1,5 @@
-// Copied from:
+// Copied from (with the addition of the allocation-free Span-based Encode/Decode, EncodeBytes,
+// StreamEncoder, StreamDecoder, DecodeLanes and DecodeBatch):
 // https://github.com/bitcoin/bitcoin/blob/master/src/bech32.h
 
 // Copyright (c) 2017 Pieter Wuille
@@ -15,6 +16,8 @@
 #ifndef BITCOIN_BECH32_H
 #define BITCOIN_BECH32_H
 
+#include <span.h>
+
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -28,6 +31,117 @@ std::string Encode(const std::string& hrp, const std::vector<uint8_t>& values);
 /** Decode a Bech32 string. Returns (hrp, data). Empty hrp means failure. */
 std::pair<std::string, std::vector<uint8_t>> Decode(const std::string& str);
 
+/** Length of the Bech32 string for a HRP and data values of the given lengths. */
+constexpr size_t EncodedLength(size_t hrp_len, size_t values_len) { return hrp_len + 1 + values_len + 6; }
+
+/** Encode a Bech32 string into out, without allocating (and without NUL terminator).
+ *  Returns the length written, or 0 if out is shorter than EncodedLength(). */
+size_t Encode(Span<char> out, Span<const char> hrp, Span<const uint8_t> values);
+
+/** Length of the Bech32 string for a HRP and bytes_len bytes of data (see EncodeBytes). */
+constexpr size_t EncodedBytesLength(size_t hrp_len, size_t bytes_len) { return EncodedLength(hrp_len, (bytes_len * 8 + 4) / 5); }
+
+/** Encode bytes as a Bech32 string into out, converting them to 5-bit values on the way (the
+ *  last one padded with zero bits, like ConvertBits<8, 5, true>). Returns the length written,
+ *  or 0 if out is shorter than EncodedBytesLength(). With upper, the whole string is written in
+ *  uppercase (e.g. for QR alphanumeric mode). */
+size_t EncodeBytes(Span<char> out, Span<const char> hrp, Span<const uint8_t> bytes, bool upper = false);
+
+/** Incremental version of EncodeBytes, for bytes which are produced in pieces (e.g. a URL
+ *  which is being written), so they don't need to be put together first. Only the bits which
+ *  don't make a whole value yet and the checksum state are kept. */
+class StreamEncoder
+{
+public:
+    /** Start a string with the given (lowercase) HRP in out. */
+    StreamEncoder(Span<char> out, Span<const char> hrp, bool upper = false);
+
+    /** Append the next bytes. Once out is too small, the rest is dropped (see Finish). */
+    void Update(Span<const uint8_t> bytes);
+
+    /** Pad the last value and append the checksum. Returns the length written (the same as
+     *  EncodeBytes for all bytes at once), or 0 if out was too small. */
+    size_t Finish();
+
+private:
+    char* m_begin;
+    char* m_it;
+    char* m_end;
+    const char* m_charset;
+    uint32_t m_mod;
+    /** Bits which don't make a whole value yet (the lowest m_bit_count bits of m_bits). */
+    uint32_t m_bits = 0;
+    int m_bit_count = 0;
+    bool m_overflow = false;
+};
+
+/** Decode a Bech32 string without allocating. On success, writes the (lowercase) HRP to hrp and
+ *  the data values (without checksum) to values, and their lengths to hrp_len and values_len.
+ *  hrp needs room for up to str.size() - 7 entries, and values for up to str.size() - 8.
+ *  Returns false on failure (or if an output is too small). */
+bool Decode(Span<const char> str, Span<char> hrp, size_t& hrp_len, Span<uint8_t> values, size_t& values_len);
+
+/** Number of strings whose checksums DecodeLanes computes at once. */
+constexpr size_t CHECKSUM_LANES = 8;
+
+/** Decode count (at most CHECKSUM_LANES) Bech32 strings at once, with the same result as Decode
+ *  for each of them. Characters are checked 16 at a time where SIMD is available, and the
+ *  checksums are computed side by side, so they don't wait on each other's table lookups.
+ *  hrps[i] and values[i] must have room for strs[i].size() entries (the checksum is mapped to
+ *  values[i] too). Returns a bitmask with bit i set if strs[i] decoded; only then are
+ *  hrp_lens[i] and values_lens[i] set. */
+unsigned DecodeLanes(const Span<const char>* strs, size_t count, const Span<char>* hrps, size_t* hrp_lens, const Span<uint8_t>* values, size_t* values_lens);
+
+/** Decode many Bech32 strings (see DecodeLanes), with the same result as Decode for each of them. */
+std::vector<std::pair<std::string, std::vector<uint8_t>>> DecodeBatch(const std::vector<std::string>& strs);
+
+/** Incremental Bech32 decoder, for strings which are received in chunks. Only the HRP and the
+ *  last 6 values (which may turn out to be the checksum) are kept, so there is no length limit
+ *  (although the checksum only guarantees error detection up to 1023 characters).
+ *
+ *  Unlike Decode, the HRP ends at the first '1' (rather than the last one), so HRPs which
+ *  contain a '1' are rejected. */
+class StreamDecoder
+{
+public:
+    static constexpr size_t MAX_HRP_LENGTH = 83;
+
+    /** Decode the next chunk. Writes the data values which are known not to be part of the
+     *  checksum to values, which must have room for chunk.size() entries, and returns their
+     *  count. They are only valid once Finish() returns true. Returns 0 after a failure. */
+    size_t Update(Span<const char> chunk, Span<uint8_t> values);
+
+    /** Check the checksum after the last chunk. Returns whether the whole string was valid. */
+    bool Finish();
+
+    bool Failed() const { return m_failed; }
+
+    /** The (lowercase) HRP, once the separator was decoded. */
+    Span<const char> Hrp() const { return Span<const char>(m_hrp, m_separator ? m_hrp_len : 0); }
+
+    void Reset()
+    {
+        m_hrp_len = m_pending_pos = m_pending_len = 0;
+        m_separator = m_lower = m_upper = m_failed = false;
+        m_mod = 1;
+    }
+
+private:
+    char m_hrp[MAX_HRP_LENGTH];
+    size_t m_hrp_len = 0;
+    bool m_separator = false;
+    bool m_lower = false;
+    bool m_upper = false;
+    bool m_failed = false;
+    uint32_t m_mod = 1;
+    /** The last values, in a ring buffer (m_pending_len of them, the oldest at m_pending_pos). */
+    uint8_t m_pending[6];
+    size_t m_pending_pos = 0;
+    size_t m_pending_len = 0;
+
+    size_t Fail() { m_failed = true; return 0; }
+};
+
 } // namespace bech32
 
 #endif // BITCOIN_BECH32_H
\ No newline at end of file
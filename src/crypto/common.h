@@ -12,6 +12,16 @@
 // #include <config/bitcoin-config.h>
 // #endif
 
+// There is no configure step, so the x86 SHA-256 backends are enabled whenever
+// the compiler can build them. They select their instruction set per function,
+// and SHA256AutoDetect() checks CPUID before using any of them.
+#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__)) && defined(__GNUC__)
+#define USE_ASM 1
+#define ENABLE_SSE41 1
+#define ENABLE_AVX2 1
+#define ENABLE_SHANI 1
+#endif
+
 #include <stdint.h>
 #include <string.h>
 
@@ -1,4 +1,4 @@
-// Copied from:
+// Copied from (with the addition of FinalizeMulti):
 // https://github.com/bitcoin/bitcoin/blob/master/src/crypto/hmac_sha256.cpp
 
 // Copyright (c) 2014-2018 The Bitcoin Core developers
@@ -34,4 +34,26 @@ void CHMAC_SHA256::Finalize(unsigned char hash[OUTPUT_SIZE])
     unsigned char temp[32];
     inner.Finalize(temp);
     outer.Write(temp, 32).Finalize(hash);
-}
\ No newline at end of file
+}
+
+void CHMAC_SHA256::FinalizeMulti(unsigned char* hashes, const unsigned char* const* data, const size_t* len, size_t count) const
+{
+    // Messages are processed in groups, so that the inner hashes fit on the stack.
+    static const size_t GROUP = 8;
+    unsigned char temp[GROUP * 32];
+    const unsigned char* temp_data[GROUP];
+    size_t temp_len[GROUP];
+    for (size_t i = 0; i < GROUP; ++i) {
+        temp_data[i] = temp + 32 * i;
+        temp_len[i] = 32;
+    }
+    while (count) {
+        const size_t n = count < GROUP ? count : GROUP;
+        inner.FinalizeMulti(temp, data, len, n);
+        outer.FinalizeMulti(hashes, temp_data, temp_len, n);
+        hashes += 32 * n;
+        data += n;
+        len += n;
+        count -= n;
+    }
+}
@@ -1,4 +1,4 @@
-// Copied from:
+// Copied from (with the addition of a default constructor, FinalizeMulti and midstate export/import):
 // https://github.com/bitcoin/bitcoin/blob/master/src/crypto/hmac_sha256.h
 
 // Copyright (c) 2014-2018 The Bitcoin Core developers
@@ -22,7 +22,11 @@ private:
 
 public:
     static const size_t OUTPUT_SIZE = 32;
+    /** Size of an exported midstate: the inner and outer CSHA256 midstates. */
+    static const size_t MIDSTATE_SIZE = 2 * CSHA256::MIDSTATE_SIZE;
 
+    /** Construct an un-keyed hasher. Assign a keyed instance before use. */
+    CHMAC_SHA256() {}
     CHMAC_SHA256(const unsigned char* key, size_t keylen);
     CHMAC_SHA256& Write(const unsigned char* data, size_t len)
     {
@@ -30,6 +34,25 @@ public:
         return *this;
     }
     void Finalize(unsigned char hash[OUTPUT_SIZE]);
+
+    /** Compute the HMAC of several messages (each following the data written so far),
+     *  using parallel SIMD lanes where supported. See CSHA256::FinalizeMulti.
+     */
+    void FinalizeMulti(unsigned char* hashes, const unsigned char* const* data, const size_t* len, size_t count) const;
+
+    /** Export the state of an unfinished HMAC (key and data written so far). See CSHA256::GetMidstate. */
+    void GetMidstate(unsigned char midstate[MIDSTATE_SIZE]) const
+    {
+        inner.GetMidstate(midstate);
+        outer.GetMidstate(midstate + CSHA256::MIDSTATE_SIZE);
+    }
+    /** Resume the HMAC from a state exported with GetMidstate. */
+    CHMAC_SHA256& SetMidstate(const unsigned char midstate[MIDSTATE_SIZE])
+    {
+        inner.SetMidstate(midstate);
+        outer.SetMidstate(midstate + CSHA256::MIDSTATE_SIZE);
+        return *this;
+    }
 };
 
 #endif // BITCOIN_CRYPTO_HMAC_SHA256_H
@@ -1,4 +1,5 @@
-// Copied from:
+// Copied from (with the addition of CSHA256::FinalizeMulti, midstate export/import, the one-time SHA256AutoDetect
+// and SHA256SelectImplementation):
 // https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256.cpp
 
 // Copyright (c) 2014-2019 The Bitcoin Core developers
@@ -21,16 +22,31 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 #endif
 #endif
 
+#ifdef ENABLE_SSE41
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in);
 }
 
+namespace sha256_sse41
+{
+void Transform_4way(uint32_t* const* s, const unsigned char* const* chunk);
+}
+#endif
+
+#ifdef ENABLE_AVX2
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
 }
 
+namespace sha256_avx2
+{
+void Transform_8way(uint32_t* const* s, const unsigned char* const* chunk);
+}
+#endif
+
+#ifdef ENABLE_SHANI
 namespace sha256d64_shani
 {
 void Transform_2way(unsigned char* out, const unsigned char* in);
@@ -39,7 +55,9 @@ void Transform_2way(unsigned char* out, const unsigned char* in);
 namespace sha256_shani
 {
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
+void Transform_2way(uint32_t* const* s, const unsigned char* const* chunk);
 }
+#endif
 
 // Internal implementation code.
 namespace
@@ -464,6 +482,31 @@ TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
 
+/** Lane-parallel transform: one 64-byte chunk per lane, each lane with its own state. */
+typedef void (*TransformMultiType)(uint32_t* const*, const unsigned char* const*);
+TransformMultiType TransformMulti_2way = nullptr;
+TransformMultiType TransformMulti_4way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
+
+/** Check a lane-parallel transform: lane i hashes block i of data starting from result[i]. */
+template<size_t N>
+bool SelfTestMulti(TransformMultiType fn, const unsigned char* data, const uint32_t (*result)[8])
+{
+    uint32_t state[N][8];
+    uint32_t* s[N];
+    const unsigned char* chunk[N];
+    for (size_t i = 0; i < N; ++i) {
+        std::copy(result[i], result[i] + 8, state[i]);
+        s[i] = state[i];
+        chunk[i] = data + 64 * i;
+    }
+    fn(s, chunk);
+    for (size_t i = 0; i < N; ++i) {
+        if (!std::equal(state[i], state[i] + 8, result[i + 1])) return false;
+    }
+    return true;
+}
+
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
     static const uint32_t init[8] = {
@@ -546,10 +589,15 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test the lane-parallel transforms used by CSHA256::FinalizeMulti, if available.
+    if (TransformMulti_2way && !SelfTestMulti<2>(TransformMulti_2way, data + 1, result)) return false;
+    if (TransformMulti_4way && !SelfTestMulti<4>(TransformMulti_4way, data + 1, result)) return false;
+    if (TransformMulti_8way && !SelfTestMulti<8>(TransformMulti_8way, data + 1, result)) return false;
+
     return true;
 }
 
-#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
 /** Check whether the OS has enabled AVX registers. */
 bool AVXEnabled()
 {
@@ -558,12 +606,88 @@ bool AVXEnabled()
     return (a & 6) == 6;
 }
 #endif
-} // namespace
 
+/** Copy 64 bytes, starting at pos, out of the concatenation of three buffers. */
+void CopyBlock(unsigned char* out, size_t pos, const unsigned char* const* seg, const size_t* seglen)
+{
+    size_t n = 64;
+    for (int i = 0; i < 3 && n; ++i) {
+        if (pos >= seglen[i]) {
+            pos -= seglen[i];
+            continue;
+        }
+        const size_t take = seglen[i] - pos < n ? seglen[i] - pos : n;
+        memcpy(out, seg[i] + pos, take);
+        out += take;
+        n -= take;
+        pos = 0;
+    }
+}
 
-std::string SHA256AutoDetect()
+/** Finish up to `lanes` (at most 8) hashes in parallel. All messages continue from
+ *  the state s, which has consumed `bytes` bytes, the last bytes % 64 of which are still in buf. */
+void FinalizeLanes(TransformMultiType fn, size_t lanes, const uint32_t* s, const unsigned char* buf, uint64_t bytes, unsigned char* hashes, const unsigned char* const* data, const size_t* len, size_t count)
+{
+    const size_t bufsize = bytes % 64;
+    uint32_t state[8][8];
+    uint32_t unused[8];
+    unsigned char pad[8][72];
+    unsigned char block[8][64];
+    size_t blocks[8];
+    size_t max_blocks = 0;
+    uint32_t* lane_state[8];
+    const unsigned char* lane_chunk[8];
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(state[i], s, sizeof(state[i]));
+        const uint64_t total = bytes + len[i];
+        const size_t padlen = 1 + ((119 - (total % 64)) % 64) + 8;
+        memset(pad[i], 0, padlen);
+        pad[i][0] = 0x80;
+        WriteBE64(pad[i] + padlen - 8, total << 3);
+        blocks[i] = (bufsize + len[i] + padlen) / 64;
+        if (blocks[i] > max_blocks) max_blocks = blocks[i];
+    }
+    for (size_t k = 0; k < max_blocks; ++k) {
+        const size_t pos = 64 * k;
+        for (size_t i = 0; i < lanes; ++i) {
+            if (i >= count || k >= blocks[i]) {
+                // Idle lane: its output is discarded.
+                lane_state[i] = unused;
+                lane_chunk[i] = buf;
+            } else if (pos >= bufsize && pos - bufsize + 64 <= len[i]) {
+                // The whole block is message data, so it can be read in place.
+                lane_state[i] = state[i];
+                lane_chunk[i] = data[i] + (pos - bufsize);
+            } else {
+                const unsigned char* seg[3] = {buf, data[i], pad[i]};
+                const size_t seglen[3] = {bufsize, len[i], blocks[i] * 64 - bufsize - len[i]};
+                CopyBlock(block[i], pos, seg, seglen);
+                lane_state[i] = state[i];
+                lane_chunk[i] = block[i];
+            }
+        }
+        fn(lane_state, lane_chunk);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            WriteBE32(hashes + 32 * i + 4 * j, state[i][j]);
+        }
+    }
+}
+
+/** Select the transforms for this CPU, among the allowed ones. See SHA256AutoDetect. */
+std::string DetectImplementation(sha256_implementation::UseImplementation use_implementation)
 {
     std::string ret = "standard";
+    Transform = sha256::Transform;
+    TransformD64 = sha256::TransformD64;
+    TransformD64_2way = nullptr;
+    TransformD64_4way = nullptr;
+    TransformD64_8way = nullptr;
+    TransformMulti_2way = nullptr;
+    TransformMulti_4way = nullptr;
+    TransformMulti_8way = nullptr;
+    (void)use_implementation;
 #if defined(USE_ASM) && defined(HAVE_GETCPUID)
     bool have_sse4 = false;
     bool have_xsave = false;
@@ -593,12 +717,16 @@ std::string SHA256AutoDetect()
         have_avx2 = (ebx >> 5) & 1;
         have_shani = (ebx >> 29) & 1;
     }
+    if (!(use_implementation & sha256_implementation::USE_SSE4)) have_sse4 = false;
+    if (!(use_implementation & sha256_implementation::USE_AVX2)) have_avx2 = false;
+    if (!(use_implementation & sha256_implementation::USE_SHANI)) have_shani = false;
 
 #if defined(ENABLE_SHANI) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_shani) {
         Transform = sha256_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_shani::Transform>;
         TransformD64_2way = sha256d64_shani::Transform_2way;
+        TransformMulti_2way = sha256_shani::Transform_2way;
         ret = "shani(1way,2way)";
         have_sse4 = false; // Disable SSE4/AVX2;
         have_avx2 = false;
@@ -613,6 +741,7 @@ std::string SHA256AutoDetect()
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformMulti_4way = sha256_sse41::Transform_4way;
         ret += ",sse41(4way)";
 #endif
     }
@@ -620,6 +749,7 @@ std::string SHA256AutoDetect()
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256_avx2::Transform_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -628,6 +758,31 @@ std::string SHA256AutoDetect()
     assert(SelfTest());
     return ret;
 }
+} // namespace
+
+
+std::string SHA256AutoDetect()
+{
+    // The function pointers are only written the first time (thread-safe, as a static local),
+    // so that calling this while other threads are hashing doesn't race with their reads.
+    static const std::string implementation = DetectImplementation(sha256_implementation::USE_ALL);
+    return implementation;
+}
+
+std::string SHA256SelectImplementation(sha256_implementation::UseImplementation use_implementation)
+{
+    SHA256AutoDetect();
+    return DetectImplementation(use_implementation);
+}
+
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+namespace
+{
+// There is no application startup hook in this library, so select the
+// transforms for this CPU when the library is loaded.
+const std::string g_sha256_implementation = SHA256AutoDetect();
+} // namespace
+#endif
 
 ////// SHA-256
 
@@ -679,6 +834,48 @@ void CSHA256::Finalize(unsigned char hash[OUTPUT_SIZE])
     WriteBE32(hash + 28, s[7]);
 }
 
+void CSHA256::FinalizeMulti(unsigned char* hashes, const unsigned char* const* data, const size_t* len, size_t count) const
+{
+    while (count) {
+        size_t n = 1;
+        if (TransformMulti_8way && count >= 5) {
+            n = count < 8 ? count : 8;
+            FinalizeLanes(TransformMulti_8way, 8, s, buf, bytes, hashes, data, len, n);
+        } else if (TransformMulti_4way && count >= 2) {
+            n = count < 4 ? count : 4;
+            FinalizeLanes(TransformMulti_4way, 4, s, buf, bytes, hashes, data, len, n);
+        } else if (TransformMulti_2way && count >= 2) {
+            n = 2;
+            FinalizeLanes(TransformMulti_2way, 2, s, buf, bytes, hashes, data, len, n);
+        } else {
+            CSHA256(*this).Write(data[0], len[0]).Finalize(hashes);
+        }
+        hashes += 32 * n;
+        data += n;
+        len += n;
+        count -= n;
+    }
+}
+
+void CSHA256::GetMidstate(unsigned char midstate[MIDSTATE_SIZE]) const
+{
+    for (int i = 0; i < 8; ++i) {
+        WriteBE32(midstate + 4 * i, s[i]);
+    }
+    WriteBE64(midstate + 32, bytes);
+    memcpy(midstate + 40, buf, 64);
+}
+
+CSHA256& CSHA256::SetMidstate(const unsigned char midstate[MIDSTATE_SIZE])
+{
+    for (int i = 0; i < 8; ++i) {
+        s[i] = ReadBE32(midstate + 4 * i);
+    }
+    bytes = ReadBE64(midstate + 32);
+    memcpy(buf, midstate + 40, 64);
+    return *this;
+}
+
 CSHA256& CSHA256::Reset()
 {
     bytes = 0;
@@ -1,4 +1,5 @@
-// Copied from:
+// Copied from (with the addition of CSHA256::FinalizeMulti, midstate export/import, the one-time SHA256AutoDetect
+// and SHA256SelectImplementation):
 // https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256.h
 
 // Copyright (c) 2014-2018 The Bitcoin Core developers
@@ -22,18 +23,51 @@ private:
 
 public:
     static const size_t OUTPUT_SIZE = 32;
+    /** Size of an exported midstate: 8 state words, the byte count and the 64-byte buffer. */
+    static const size_t MIDSTATE_SIZE = 32 + 8 + 64;
 
     CSHA256();
     CSHA256& Write(const unsigned char* data, size_t len);
     void Finalize(unsigned char hash[OUTPUT_SIZE]);
     CSHA256& Reset();
+
+    /** Hash several messages that all start with the data written so far.
+     *  Equivalent to CSHA256(*this).Write(data[i], len[i]).Finalize(hashes + 32 * i)
+     *  for each of the `count` messages, but independent messages are hashed in
+     *  parallel SIMD lanes where the CPU supports it. This object is not modified.
+     */
+    void FinalizeMulti(unsigned char* hashes, const unsigned char* const* data, const size_t* len, size_t count) const;
+
+    /** Export the state of an unfinished hash (e.g. after writing a common prefix). */
+    void GetMidstate(unsigned char midstate[MIDSTATE_SIZE]) const;
+    /** Resume the hash from a state exported with GetMidstate. */
+    CSHA256& SetMidstate(const unsigned char midstate[MIDSTATE_SIZE]);
+};
+
+namespace sha256_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_SSE4 = 1 << 0, // Including the 4-way SSE4.1 transforms.
+    USE_AVX2 = 1 << 1,
+    USE_SHANI = 1 << 2,
+    USE_SSE4_AND_AVX2 = USE_SSE4 | USE_AVX2,
+    USE_SSE4_AND_SHANI = USE_SSE4 | USE_SHANI,
+    USE_ALL = USE_SSE4 | USE_AVX2 | USE_SHANI,
 };
+}
 
 /** Autodetect the best available SHA256 implementation.
- *  Returns the name of the implementation.
+ *  Returns the name of the implementation. The implementation is only selected by the
+ *  first call (when the library is loaded, where CPUID is used), so this is thread-safe.
  */
 std::string SHA256AutoDetect();
 
+/** Select the best available SHA256 implementation among the given instruction sets (e.g. to
+ *  compare them with the standard one in tests). Returns the name of the implementation.
+ *  Unlike SHA256AutoDetect this is not thread-safe: no other thread may hash meanwhile.
+ */
+std::string SHA256SelectImplementation(sha256_implementation::UseImplementation use_implementation);
+
 /** Compute multiple double-SHA256's of 64-byte blobs.
  *  output:  pointer to a blocks*32 byte output buffer
  *  input:   pointer to a blocks*64 byte input buffer
@@ -0,0 +1,53 @@
+// Based on (with the rounds moved to sha256_multiway.h, an 8-way Transform of separate states,
+// and per-function target pragmas instead of -mavx2):
+// https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256_avx2.cpp
+
+// Copyright (c) 2018-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 8-way SHA-256 (and double-SHA256 of 64-byte inputs) for x86 CPUs with AVX2.
+// The target is selected per function below (instead of with -mavx2), so this
+// file can be built with the same flags as the rest of the library and is only
+// used after a runtime check.
+
+#include <crypto/common.h>
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include <crypto/sha256_multiway.h>
+
+namespace sha256_avx2
+{
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+
+void Transform_8way(uint32_t* const* s, const unsigned char* const* chunk)
+{
+    sha256_multiway::Transform<v8u32, 8>(s, chunk);
+}
+}
+
+namespace sha256d64_avx2
+{
+void Transform_8way(unsigned char* out, const unsigned char* in)
+{
+    sha256_multiway::TransformD64<sha256_avx2::v8u32, 8>(out, in);
+}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
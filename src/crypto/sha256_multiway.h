@@ -0,0 +1,143 @@
+// Based on (the lane-parallel rounds of sha256_sse41.cpp and sha256_avx2.cpp, written once with
+// GCC vector extensions for any lane count, with separate states and chunks per lane):
+// https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256_sse41.cpp
+
+// Copyright (c) 2014-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Lane-parallel SHA-256 compression, shared by the per-instruction-set
+// backends (sha256_sse41.cpp, sha256_avx2.cpp). It is written with GCC vector
+// extensions, so it must be included after the backend has selected its target
+// (see the pragmas there); each backend then gets its own copy compiled for
+// that instruction set. Everything here has internal linkage for that reason.
+
+#ifndef BITCOIN_CRYPTO_SHA256_MULTIWAY_H
+#define BITCOIN_CRYPTO_SHA256_MULTIWAY_H
+
+#include <crypto/common.h>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+namespace sha256_multiway {
+
+const uint32_t K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+};
+
+template<int n, typename V> inline V Rotr(V x) { return (x >> n) | (x << (32 - n)); }
+
+template<typename V> inline V Ch(V x, V y, V z) { return z ^ (x & (y ^ z)); }
+template<typename V> inline V Maj(V x, V y, V z) { return (x & y) | (z & (x | y)); }
+template<typename V> inline V Sigma0(V x) { return Rotr<2>(x) ^ Rotr<13>(x) ^ Rotr<22>(x); }
+template<typename V> inline V Sigma1(V x) { return Rotr<6>(x) ^ Rotr<11>(x) ^ Rotr<25>(x); }
+template<typename V> inline V sigma0(V x) { return Rotr<7>(x) ^ Rotr<18>(x) ^ (x >> 3); }
+template<typename V> inline V sigma1(V x) { return Rotr<17>(x) ^ Rotr<19>(x) ^ (x >> 10); }
+
+/** Perform one SHA-256 transformation in each of the N lanes of V.
+ *  Lane i continues from state s[i] (8 words, updated in place) and consumes
+ *  the 64-byte chunk[i]. The lanes are fully independent.
+ */
+template<typename V, int N>
+void Transform(uint32_t* const* s, const unsigned char* const* chunk)
+{
+    V a, b, c, d, e, f, g, h;
+    V w[16];
+    for (int i = 0; i < N; ++i) {
+        a[i] = s[i][0]; b[i] = s[i][1]; c[i] = s[i][2]; d[i] = s[i][3];
+        e[i] = s[i][4]; f[i] = s[i][5]; g[i] = s[i][6]; h[i] = s[i][7];
+        for (int j = 0; j < 16; ++j) {
+            w[j][i] = ReadBE32(chunk[i] + 4 * j);
+        }
+    }
+    const V a0 = a, b0 = b, c0 = c, d0 = d, e0 = e, f0 = f, g0 = g, h0 = h;
+
+    for (int r = 0; r < 64; ++r) {
+        V& wr = w[r & 15];
+        if (r >= 16) {
+            wr += sigma1(w[(r + 14) & 15]) + w[(r + 9) & 15] + sigma0(w[(r + 1) & 15]);
+        }
+        const V t1 = h + Sigma1(e) + Ch(e, f, g) + K[r] + wr;
+        const V t2 = Sigma0(a) + Maj(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    a += a0; b += b0; c += c0; d += d0; e += e0; f += f0; g += g0; h += h0;
+    for (int i = 0; i < N; ++i) {
+        s[i][0] = a[i]; s[i][1] = b[i]; s[i][2] = c[i]; s[i][3] = d[i];
+        s[i][4] = e[i]; s[i][5] = f[i]; s[i][6] = g[i]; s[i][7] = h[i];
+    }
+}
+
+/** Compute the double-SHA256 of N independent 64-byte inputs (in + 64 * i),
+ *  writing the N 32-byte results to out + 32 * i.
+ */
+template<typename V, int N>
+void TransformD64(unsigned char* out, const unsigned char* in)
+{
+    static const uint32_t init[8] = {
+        0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul
+    };
+    static const unsigned char padding1[64] = {
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0
+    };
+    uint32_t state[N][8];
+    unsigned char buffer2[N][64];
+    uint32_t* s[N];
+    const unsigned char* chunk[N];
+
+    // First hash: the input block, then the padding for 64 bytes.
+    for (int i = 0; i < N; ++i) {
+        memcpy(state[i], init, sizeof(init));
+        s[i] = state[i];
+        chunk[i] = in + 64 * i;
+    }
+    Transform<V, N>(s, chunk);
+    for (int i = 0; i < N; ++i) {
+        chunk[i] = padding1;
+    }
+    Transform<V, N>(s, chunk);
+
+    // Second hash: the 32-byte first hash, padded to a single block.
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            WriteBE32(buffer2[i] + 4 * j, state[i][j]);
+        }
+        memset(buffer2[i] + 32, 0, 32);
+        buffer2[i][32] = 0x80;
+        buffer2[i][62] = 1;
+        memcpy(state[i], init, sizeof(init));
+        chunk[i] = buffer2[i];
+    }
+    Transform<V, N>(s, chunk);
+
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            WriteBE32(out + 32 * i + 4 * j, state[i][j]);
+        }
+    }
+}
+
+} // namespace sha256_multiway
+} // namespace
+
+#endif // BITCOIN_CRYPTO_SHA256_MULTIWAY_H
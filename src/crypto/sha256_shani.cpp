@@ -0,0 +1,306 @@
+// Copied from (with a 2-way Transform of separate states, and per-function target pragmas
+// instead of -msse4 -msha):
+// https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256_shani.cpp
+
+// Copyright (c) 2018-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// Based on https://github.com/noloader/SHA-Intrinsics/blob/master/sha256-x86.c,
+// Written and placed in public domain by Jeffrey Walton.
+// Based on code from Intel, and by Sean Gulley for the miTLS project.
+
+// SHA-256 for x86 CPUs with the SHA extensions. The target is selected per
+// function below (instead of with -msha), so this file can be built with the
+// same flags as the rest of the library and is only used after a runtime check.
+
+#include <crypto/common.h>
+
+#ifdef ENABLE_SHANI
+
+#include <stdint.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1,sha"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1,sha")
+#endif
+
+#include <immintrin.h>
+
+namespace {
+
+alignas(__m128i) const uint8_t MASK[16] = {0x03, 0x02, 0x01, 0x00, 0x07, 0x06, 0x05, 0x04, 0x0b, 0x0a, 0x09, 0x08, 0x0f, 0x0e, 0x0d, 0x0c};
+
+void inline __attribute__((always_inline)) QuadRound(__m128i& state0, __m128i& state1, __m128i m, uint64_t k1, uint64_t k0)
+{
+    const __m128i msg = _mm_add_epi32(m, _mm_set_epi64x(k1, k0));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e));
+}
+
+void inline __attribute__((always_inline)) ShiftMessageA(__m128i& m0, __m128i m1)
+{
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+}
+
+void inline __attribute__((always_inline)) ShiftMessageC(__m128i& m0, __m128i m1, __m128i& m2)
+{
+    m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, _mm_alignr_epi8(m1, m0, 4)), m1);
+}
+
+void inline __attribute__((always_inline)) ShiftMessageB(__m128i& m0, __m128i m1, __m128i& m2)
+{
+    ShiftMessageC(m0, m1, m2);
+    ShiftMessageA(m0, m1);
+}
+
+/** Convert the state words (a..h) into the ABEF/CDGH layout used by the SHA instructions. */
+void inline __attribute__((always_inline)) Shuffle(__m128i& s0, __m128i& s1)
+{
+    const __m128i t1 = _mm_shuffle_epi32(s0, 0xB1);
+    const __m128i t2 = _mm_shuffle_epi32(s1, 0x1B);
+    s0 = _mm_alignr_epi8(t1, t2, 0x08);
+    s1 = _mm_blend_epi16(t2, t1, 0xF0);
+}
+
+/** Inverse of Shuffle(). */
+void inline __attribute__((always_inline)) Unshuffle(__m128i& s0, __m128i& s1)
+{
+    const __m128i t1 = _mm_shuffle_epi32(s0, 0x1B);
+    const __m128i t2 = _mm_shuffle_epi32(s1, 0xB1);
+    s0 = _mm_blend_epi16(t1, t2, 0xF0);
+    s1 = _mm_alignr_epi8(t2, t1, 0x08);
+}
+
+__m128i inline __attribute__((always_inline)) Load(const unsigned char* in)
+{
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), _mm_load_si128((const __m128i*)MASK));
+}
+
+} // namespace
+
+namespace sha256_shani {
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    __m128i m0, m1, m2, m3, s0, s1, so0, so1;
+
+    /* Load state */
+    s0 = _mm_loadu_si128((const __m128i*)s);
+    s1 = _mm_loadu_si128((const __m128i*)(s + 4));
+    Shuffle(s0, s1);
+
+    while (blocks--) {
+        /* Remember old state */
+        so0 = s0;
+        so1 = s1;
+
+        /* Load data and transform */
+        m0 = Load(chunk + 0);
+        QuadRound(s0, s1, m0, 0xe9b5dba5b5c0fbcfull, 0x71374491428a2f98ull);
+        m1 = Load(chunk + 16);
+        QuadRound(s0, s1, m1, 0xab1c5ed5923f82a4ull, 0x59f111f13956c25bull);
+        ShiftMessageA(m0, m1);
+        m2 = Load(chunk + 32);
+        QuadRound(s0, s1, m2, 0x550c7dc3243185beull, 0x12835b01d807aa98ull);
+        ShiftMessageA(m1, m2);
+        m3 = Load(chunk + 48);
+        QuadRound(s0, s1, m3, 0xc19bf1749bdc06a7ull, 0x80deb1fe72be5d74ull);
+        ShiftMessageB(m2, m3, m0);
+        QuadRound(s0, s1, m0, 0x240ca1cc0fc19dc6ull, 0xefbe4786e49b69c1ull);
+        ShiftMessageB(m3, m0, m1);
+        QuadRound(s0, s1, m1, 0x76f988da5cb0a9dcull, 0x4a7484aa2de92c6full);
+        ShiftMessageB(m0, m1, m2);
+        QuadRound(s0, s1, m2, 0xbf597fc7b00327c8ull, 0xa831c66d983e5152ull);
+        ShiftMessageB(m1, m2, m3);
+        QuadRound(s0, s1, m3, 0x1429296706ca6351ull, 0xd5a79147c6e00bf3ull);
+        ShiftMessageB(m2, m3, m0);
+        QuadRound(s0, s1, m0, 0x53380d134d2c6dfcull, 0x2e1b213827b70a85ull);
+        ShiftMessageB(m3, m0, m1);
+        QuadRound(s0, s1, m1, 0x92722c8581c2c92eull, 0x766a0abb650a7354ull);
+        ShiftMessageB(m0, m1, m2);
+        QuadRound(s0, s1, m2, 0xc76c51a3c24b8b70ull, 0xa81a664ba2bfe8a1ull);
+        ShiftMessageB(m1, m2, m3);
+        QuadRound(s0, s1, m3, 0x106aa070f40e3585ull, 0xd6990624d192e819ull);
+        ShiftMessageB(m2, m3, m0);
+        QuadRound(s0, s1, m0, 0x34b0bcb52748774cull, 0x1e376c0819a4c116ull);
+        ShiftMessageB(m3, m0, m1);
+        QuadRound(s0, s1, m1, 0x682e6ff35b9cca4full, 0x4ed8aa4a391c0cb3ull);
+        ShiftMessageC(m0, m1, m2);
+        QuadRound(s0, s1, m2, 0x8cc7020884c87814ull, 0x78a5636f748f82eeull);
+        ShiftMessageC(m1, m2, m3);
+        QuadRound(s0, s1, m3, 0xc67178f2bef9a3f7ull, 0xa4506ceb90befffaull);
+
+        /* Combine with old state */
+        s0 = _mm_add_epi32(s0, so0);
+        s1 = _mm_add_epi32(s1, so1);
+
+        /* Advance */
+        chunk += 64;
+    }
+
+    Unshuffle(s0, s1);
+    _mm_storeu_si128((__m128i*)s, s0);
+    _mm_storeu_si128((__m128i*)(s + 4), s1);
+}
+
+/** Perform one transformation in each of two independent streams, interleaving
+ *  their instructions so that the two dependency chains overlap. */
+void Transform_2way(uint32_t* const* s, const unsigned char* const* chunk)
+{
+    __m128i m0a, m1a, m2a, m3a, s0a, s1a, so0a, so1a;
+    __m128i m0b, m1b, m2b, m3b, s0b, s1b, so0b, so1b;
+    const unsigned char* chunka = chunk[0];
+    const unsigned char* chunkb = chunk[1];
+
+    /* Load state */
+    s0a = _mm_loadu_si128((const __m128i*)s[0]);
+    s1a = _mm_loadu_si128((const __m128i*)(s[0] + 4));
+    s0b = _mm_loadu_si128((const __m128i*)s[1]);
+    s1b = _mm_loadu_si128((const __m128i*)(s[1] + 4));
+    Shuffle(s0a, s1a);
+    Shuffle(s0b, s1b);
+
+    /* Remember old state */
+    so0a = s0a;
+    so1a = s1a;
+    so0b = s0b;
+    so1b = s1b;
+
+    /* Load data and transform */
+        m0a = Load(chunka + 0);
+        m0b = Load(chunkb + 0);
+        QuadRound(s0a, s1a, m0a, 0xe9b5dba5b5c0fbcfull, 0x71374491428a2f98ull);
+        QuadRound(s0b, s1b, m0b, 0xe9b5dba5b5c0fbcfull, 0x71374491428a2f98ull);
+        m1a = Load(chunka + 16);
+        m1b = Load(chunkb + 16);
+        QuadRound(s0a, s1a, m1a, 0xab1c5ed5923f82a4ull, 0x59f111f13956c25bull);
+        QuadRound(s0b, s1b, m1b, 0xab1c5ed5923f82a4ull, 0x59f111f13956c25bull);
+        ShiftMessageA(m0a, m1a);
+        ShiftMessageA(m0b, m1b);
+        m2a = Load(chunka + 32);
+        m2b = Load(chunkb + 32);
+        QuadRound(s0a, s1a, m2a, 0x550c7dc3243185beull, 0x12835b01d807aa98ull);
+        QuadRound(s0b, s1b, m2b, 0x550c7dc3243185beull, 0x12835b01d807aa98ull);
+        ShiftMessageA(m1a, m2a);
+        ShiftMessageA(m1b, m2b);
+        m3a = Load(chunka + 48);
+        m3b = Load(chunkb + 48);
+        QuadRound(s0a, s1a, m3a, 0xc19bf1749bdc06a7ull, 0x80deb1fe72be5d74ull);
+        QuadRound(s0b, s1b, m3b, 0xc19bf1749bdc06a7ull, 0x80deb1fe72be5d74ull);
+        ShiftMessageB(m2a, m3a, m0a);
+        ShiftMessageB(m2b, m3b, m0b);
+        QuadRound(s0a, s1a, m0a, 0x240ca1cc0fc19dc6ull, 0xefbe4786e49b69c1ull);
+        QuadRound(s0b, s1b, m0b, 0x240ca1cc0fc19dc6ull, 0xefbe4786e49b69c1ull);
+        ShiftMessageB(m3a, m0a, m1a);
+        ShiftMessageB(m3b, m0b, m1b);
+        QuadRound(s0a, s1a, m1a, 0x76f988da5cb0a9dcull, 0x4a7484aa2de92c6full);
+        QuadRound(s0b, s1b, m1b, 0x76f988da5cb0a9dcull, 0x4a7484aa2de92c6full);
+        ShiftMessageB(m0a, m1a, m2a);
+        ShiftMessageB(m0b, m1b, m2b);
+        QuadRound(s0a, s1a, m2a, 0xbf597fc7b00327c8ull, 0xa831c66d983e5152ull);
+        QuadRound(s0b, s1b, m2b, 0xbf597fc7b00327c8ull, 0xa831c66d983e5152ull);
+        ShiftMessageB(m1a, m2a, m3a);
+        ShiftMessageB(m1b, m2b, m3b);
+        QuadRound(s0a, s1a, m3a, 0x1429296706ca6351ull, 0xd5a79147c6e00bf3ull);
+        QuadRound(s0b, s1b, m3b, 0x1429296706ca6351ull, 0xd5a79147c6e00bf3ull);
+        ShiftMessageB(m2a, m3a, m0a);
+        ShiftMessageB(m2b, m3b, m0b);
+        QuadRound(s0a, s1a, m0a, 0x53380d134d2c6dfcull, 0x2e1b213827b70a85ull);
+        QuadRound(s0b, s1b, m0b, 0x53380d134d2c6dfcull, 0x2e1b213827b70a85ull);
+        ShiftMessageB(m3a, m0a, m1a);
+        ShiftMessageB(m3b, m0b, m1b);
+        QuadRound(s0a, s1a, m1a, 0x92722c8581c2c92eull, 0x766a0abb650a7354ull);
+        QuadRound(s0b, s1b, m1b, 0x92722c8581c2c92eull, 0x766a0abb650a7354ull);
+        ShiftMessageB(m0a, m1a, m2a);
+        ShiftMessageB(m0b, m1b, m2b);
+        QuadRound(s0a, s1a, m2a, 0xc76c51a3c24b8b70ull, 0xa81a664ba2bfe8a1ull);
+        QuadRound(s0b, s1b, m2b, 0xc76c51a3c24b8b70ull, 0xa81a664ba2bfe8a1ull);
+        ShiftMessageB(m1a, m2a, m3a);
+        ShiftMessageB(m1b, m2b, m3b);
+        QuadRound(s0a, s1a, m3a, 0x106aa070f40e3585ull, 0xd6990624d192e819ull);
+        QuadRound(s0b, s1b, m3b, 0x106aa070f40e3585ull, 0xd6990624d192e819ull);
+        ShiftMessageB(m2a, m3a, m0a);
+        ShiftMessageB(m2b, m3b, m0b);
+        QuadRound(s0a, s1a, m0a, 0x34b0bcb52748774cull, 0x1e376c0819a4c116ull);
+        QuadRound(s0b, s1b, m0b, 0x34b0bcb52748774cull, 0x1e376c0819a4c116ull);
+        ShiftMessageB(m3a, m0a, m1a);
+        ShiftMessageB(m3b, m0b, m1b);
+        QuadRound(s0a, s1a, m1a, 0x682e6ff35b9cca4full, 0x4ed8aa4a391c0cb3ull);
+        QuadRound(s0b, s1b, m1b, 0x682e6ff35b9cca4full, 0x4ed8aa4a391c0cb3ull);
+        ShiftMessageC(m0a, m1a, m2a);
+        ShiftMessageC(m0b, m1b, m2b);
+        QuadRound(s0a, s1a, m2a, 0x8cc7020884c87814ull, 0x78a5636f748f82eeull);
+        QuadRound(s0b, s1b, m2b, 0x8cc7020884c87814ull, 0x78a5636f748f82eeull);
+        ShiftMessageC(m1a, m2a, m3a);
+        ShiftMessageC(m1b, m2b, m3b);
+        QuadRound(s0a, s1a, m3a, 0xc67178f2bef9a3f7ull, 0xa4506ceb90befffaull);
+        QuadRound(s0b, s1b, m3b, 0xc67178f2bef9a3f7ull, 0xa4506ceb90befffaull);
+
+    /* Combine with old state */
+    s0a = _mm_add_epi32(s0a, so0a);
+    s1a = _mm_add_epi32(s1a, so1a);
+    s0b = _mm_add_epi32(s0b, so0b);
+    s1b = _mm_add_epi32(s1b, so1b);
+
+    Unshuffle(s0a, s1a);
+    Unshuffle(s0b, s1b);
+    _mm_storeu_si128((__m128i*)s[0], s0a);
+    _mm_storeu_si128((__m128i*)(s[0] + 4), s1a);
+    _mm_storeu_si128((__m128i*)s[1], s0b);
+    _mm_storeu_si128((__m128i*)(s[1] + 4), s1b);
+}
+}
+
+namespace sha256d64_shani {
+/** Compute the double-SHA256 of two independent 64-byte inputs. */
+void Transform_2way(unsigned char* out, const unsigned char* in)
+{
+    static const uint32_t init[8] = {
+        0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul
+    };
+    static const unsigned char padding1[64] = {
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0
+    };
+    uint32_t state[2][8];
+    uint32_t* s[2] = {state[0], state[1]};
+    unsigned char buffer2[2][64];
+    const unsigned char* chunk[2] = {in, in + 64};
+
+    memcpy(state[0], init, sizeof(init));
+    memcpy(state[1], init, sizeof(init));
+    sha256_shani::Transform_2way(s, chunk);
+    chunk[0] = chunk[1] = padding1;
+    sha256_shani::Transform_2way(s, chunk);
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            WriteBE32(buffer2[i] + 4 * j, state[i][j]);
+        }
+        memset(buffer2[i] + 32, 0, 32);
+        buffer2[i][32] = 0x80;
+        buffer2[i][62] = 1;
+        memcpy(state[i], init, sizeof(init));
+        chunk[i] = buffer2[i];
+    }
+    sha256_shani::Transform_2way(s, chunk);
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            WriteBE32(out + 32 * i + 4 * j, state[i][j]);
+        }
+    }
+}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
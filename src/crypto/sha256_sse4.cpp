@@ -0,0 +1,125 @@
+// Based on (rewritten with SSE4.1 intrinsics instead of Intel's assembly):
+// https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256_sse4.cpp
+
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// SHA-256 for x86-64 CPUs with SSE4.1. The message schedule of each block is
+// expanded four words at a time in SSE registers (with the round constants
+// already added), which leaves only the round function for the scalar units.
+// The target is selected per function below (instead of with -msse4.1), so
+// this file can be built with the same flags as the rest of the library and is
+// only used after a runtime check.
+
+#include <crypto/common.h>
+
+#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__))
+
+#include <stdint.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+#include <immintrin.h>
+
+namespace {
+
+alignas(__m128i) const uint32_t K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+};
+
+alignas(__m128i) const uint8_t MASK[16] = {0x03, 0x02, 0x01, 0x00, 0x07, 0x06, 0x05, 0x04, 0x0b, 0x0a, 0x09, 0x08, 0x0f, 0x0e, 0x0d, 0x0c};
+
+template<int n> inline __m128i Rotr(__m128i x) { return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n)); }
+inline __m128i sigma0(__m128i x) { return _mm_xor_si128(_mm_xor_si128(Rotr<7>(x), Rotr<18>(x)), _mm_srli_epi32(x, 3)); }
+inline __m128i sigma1(__m128i x) { return _mm_xor_si128(_mm_xor_si128(Rotr<17>(x), Rotr<19>(x)), _mm_srli_epi32(x, 10)); }
+
+inline uint32_t Ch(uint32_t x, uint32_t y, uint32_t z) { return z ^ (x & (y ^ z)); }
+inline uint32_t Maj(uint32_t x, uint32_t y, uint32_t z) { return (x & y) | (z & (x | y)); }
+inline uint32_t Sigma0(uint32_t x) { return (x >> 2 | x << 30) ^ (x >> 13 | x << 19) ^ (x >> 22 | x << 10); }
+inline uint32_t Sigma1(uint32_t x) { return (x >> 6 | x << 26) ^ (x >> 11 | x << 21) ^ (x >> 25 | x << 7); }
+
+/** Compute the next four message words from the previous sixteen (x0..x3, oldest first). */
+inline __m128i Schedule(__m128i x0, __m128i x1, __m128i x2, __m128i x3)
+{
+    // w[t] = sigma1(w[t-2]) + w[t-7] + sigma0(w[t-15]) + w[t-16]
+    __m128i w = _mm_add_epi32(_mm_add_epi32(x0, sigma0(_mm_alignr_epi8(x1, x0, 4))), _mm_alignr_epi8(x3, x2, 4));
+    // The first two words depend on the last two words of x3...
+    const __m128i lo = sigma1(_mm_srli_si128(x3, 8));
+    w = _mm_add_epi32(w, _mm_move_epi64(lo));
+    // ...and the last two words on the first two words just computed.
+    const __m128i hi = sigma1(_mm_slli_si128(w, 8));
+    return _mm_add_epi32(w, _mm_blend_epi16(_mm_setzero_si128(), hi, 0xF0));
+}
+
+} // namespace
+
+namespace sha256_sse4
+{
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    alignas(__m128i) uint32_t wk[64];
+    const __m128i mask = _mm_load_si128((const __m128i*)MASK);
+    while (blocks--) {
+        __m128i x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)chunk), mask);
+        __m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(chunk + 16)), mask);
+        __m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(chunk + 32)), mask);
+        __m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(chunk + 48)), mask);
+        _mm_store_si128((__m128i*)(wk + 0), _mm_add_epi32(x0, _mm_load_si128((const __m128i*)(K + 0))));
+        _mm_store_si128((__m128i*)(wk + 4), _mm_add_epi32(x1, _mm_load_si128((const __m128i*)(K + 4))));
+        _mm_store_si128((__m128i*)(wk + 8), _mm_add_epi32(x2, _mm_load_si128((const __m128i*)(K + 8))));
+        _mm_store_si128((__m128i*)(wk + 12), _mm_add_epi32(x3, _mm_load_si128((const __m128i*)(K + 12))));
+        for (int t = 16; t < 64; t += 4) {
+            const __m128i w = Schedule(x0, x1, x2, x3);
+            _mm_store_si128((__m128i*)(wk + t), _mm_add_epi32(w, _mm_load_si128((const __m128i*)(K + t))));
+            x0 = x1;
+            x1 = x2;
+            x2 = x3;
+            x3 = w;
+        }
+
+        uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int t = 0; t < 64; ++t) {
+            const uint32_t t1 = h + Sigma1(e) + Ch(e, f, g) + wk[t];
+            const uint32_t t2 = Sigma0(a) + Maj(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        s[0] += a;
+        s[1] += b;
+        s[2] += c;
+        s[3] += d;
+        s[4] += e;
+        s[5] += f;
+        s[6] += g;
+        s[7] += h;
+        chunk += 64;
+    }
+}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+// Based on (with the rounds moved to sha256_multiway.h, a 4-way Transform of separate states,
+// and per-function target pragmas instead of -msse4.1):
+// https://github.com/bitcoin/bitcoin/blob/master/src/crypto/sha256_sse41.cpp
+
+// Copyright (c) 2018-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 4-way SHA-256 (and double-SHA256 of 64-byte inputs) for x86 CPUs with
+// SSE4.1. The target is selected per function below (instead of with -msse4.1),
+// so this file can be built with the same flags as the rest of the library and
+// is only used after a runtime check.
+
+#include <crypto/common.h>
+
+#ifdef ENABLE_SSE41
+
+#include <stdint.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+#include <crypto/sha256_multiway.h>
+
+namespace sha256_sse41
+{
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+
+void Transform_4way(uint32_t* const* s, const unsigned char* const* chunk)
+{
+    sha256_multiway::Transform<v4u32, 4>(s, chunk);
+}
+}
+
+namespace sha256d64_sse41
+{
+void Transform_4way(unsigned char* out, const unsigned char* in)
+{
+    sha256_multiway::TransformD64<sha256_sse41::v4u32, 4>(out, in);
+}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
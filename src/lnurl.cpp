@@ -17,31 +17,411 @@
 
 #include "lnurl.h"
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef LNURL_THREADS
+#include <thread>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace {
 
-	const std::string encodeUriComponentSafeChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.!~*'()";
+	// Non-zero for the characters which encodeURIComponent keeps intact:
+	// A-Z a-z 0-9 - _ . ! ~ * ' ( )
+	const unsigned char encodeUriComponentSafeChars[256] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 0,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+		0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+		0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	};
 
-	const std::map<std::string, std::string> shortenKeysLookupTable {
-		{ "id", "id" },
-		{ "nonce", "n" },
+	struct ReservedKey {
+		const char* key;
+		const char* shortKey;
+	};
+
+	// The reserved param keys (and their shortened forms), each in the slot given by
+	// reserved_key_hash, which is collision-free for this set of keys.
+	const ReservedKey reservedKeys[32] = {
+		{ nullptr, nullptr },
+		{ "t", "t" },
+		{ nullptr, nullptr },
 		{ "signature", "s" },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
 		{ "tag", "t" },
 		{ "minWithdrawable", "pn" },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ "n", "n" },
+		{ nullptr, nullptr },
 		{ "maxWithdrawable", "px" },
-		{ "defaultDescription", "pd" }
+		{ nullptr, nullptr },
+		{ "defaultDescription", "pd" },
+		{ nullptr, nullptr },
+		{ nullptr, nullptr },
+		{ "nonce", "n" },
+		{ "s", "s" },
+		{ "px", "px" },
+		{ "id", "id" },
+		{ "pn", "pn" },
+		{ nullptr, nullptr },
+		{ "pd", "pd" },
+		{ nullptr, nullptr },
 	};
 
-	const std::map<std::string, std::string> shortenTagsLookupTable {
-		{ "withdrawRequest", "w" }
+	size_t reserved_key_hash(Span<const char> key) {
+		const unsigned char first = key[0];
+		const unsigned char second = key[key.size() > 1 ? 1 : 0];
+		return (5 * first + 3 * second + key.size()) & 31;
+	}
+
+	// Returns the reserved key entry for key, or nullptr if key isn't reserved.
+	const ReservedKey* find_reserved_key(Span<const char> key) {
+		if (key.empty()) {
+			return nullptr;
+		}
+		const ReservedKey* slot = &reservedKeys[reserved_key_hash(key)];
+		if (slot->key == nullptr || strlen(slot->key) != key.size() || memcmp(slot->key, key.data(), key.size()) != 0) {
+			return nullptr;
+		}
+		return slot;
+	}
+
+	// Orders keys in the same way as std::string::compare (and so Lnurl::Query).
+	int compare_keys(Span<const char> a, Span<const char> b) {
+		const size_t length = std::min(a.size(), b.size());
+		const int result = length ? memcmp(a.data(), b.data(), length) : 0;
+		if (result != 0) {
+			return result;
+		}
+		return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+	}
+
+	// Index of the first param of query with a key not less than key.
+	size_t lower_bound(const Lnurl::FlatQuery &query, Span<const char> key) {
+		size_t lo = 0;
+		size_t hi = query.size();
+		while (lo < hi) {
+			const size_t mid = (lo + hi) / 2;
+			if (compare_keys(query.key(mid), key) < 0) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		return lo;
+	}
+
+	template<typename F>
+	void for_each_param(const Lnurl::Query &query, const F& fn) {
+		for (auto const &it : query) {
+			fn(Span<const char>(it.first), Span<const char>(it.second));
+		}
+	}
+
+	template<typename F>
+	void for_each_param(const Lnurl::FlatQuery &query, const F& fn) {
+		for (size_t i = 0; i < query.size(); ++i) {
+			fn(query.key(i), query.value(i));
+		}
+	}
+
+	const char* hexDigitsUpper = "0123456789ABCDEF";
+
+	// A query parameter which refers to (instead of copying) its key and value.
+	struct ParamRef {
+		const char* key;
+		Span<const char> value;
 	};
 
-	std::string string_to_hex(const std::string& in) {
-		std::stringstream ss;
-		ss << std::hex << std::setfill('0');
-		for (size_t i = 0; in.length() > i; ++i) {
-			ss << std::setw(2) << static_cast<unsigned int>(static_cast<unsigned char>(in[i]));
+	bool param_ref_less(const ParamRef &a, const ParamRef &b) {
+		return strcmp(a.key, b.key) < 0;
+	}
+
+#if defined(__SSE2__)
+	// 0xFF in each byte of x which is within [lo, hi] (both in 0x01..0x7E).
+	inline __m128i in_range(__m128i x, char lo, char hi) {
+		// Signed comparisons, so bytes >= 0x80 are never in range.
+		return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(x, _mm_set1_epi8(hi + 1)));
+	}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	// 0xFF in each byte of x which is within [lo, hi].
+	inline uint8x16_t in_range(uint8x16_t x, uint8_t lo, uint8_t hi) {
+		return vandq_u8(vcgeq_u8(x, vdupq_n_u8(lo)), vcleq_u8(x, vdupq_n_u8(hi)));
+	}
+#endif
+
+	// Number of characters at the start of [begin, end) which encodeURIComponent keeps intact.
+	size_t safe_run_length(const char* begin, const char* end) {
+		const char* it = begin;
+#if defined(__SSE2__)
+		for (; end - it >= 16; it += 16) {
+			const __m128i x = _mm_loadu_si128((const __m128i*)it);
+			__m128i safe = _mm_or_si128(in_range(x, '0', '9'), in_range(x, 'A', 'Z'));
+			safe = _mm_or_si128(safe, in_range(x, 'a', 'z'));
+			safe = _mm_or_si128(safe, in_range(x, '\'', '*'));
+			safe = _mm_or_si128(safe, in_range(x, '-', '.'));
+			safe = _mm_or_si128(safe, _mm_cmpeq_epi8(x, _mm_set1_epi8('!')));
+			safe = _mm_or_si128(safe, _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+			safe = _mm_or_si128(safe, _mm_cmpeq_epi8(x, _mm_set1_epi8('~')));
+			const unsigned int mask = _mm_movemask_epi8(safe);
+			if (mask != 0xFFFF) {
+				return (it - begin) + __builtin_ctz(~mask);
+			}
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		for (; end - it >= 16; it += 16) {
+			const uint8x16_t x = vld1q_u8((const uint8_t*)it);
+			uint8x16_t safe = vorrq_u8(in_range(x, '0', '9'), in_range(x, 'A', 'Z'));
+			safe = vorrq_u8(safe, in_range(x, 'a', 'z'));
+			safe = vorrq_u8(safe, in_range(x, '\'', '*'));
+			safe = vorrq_u8(safe, in_range(x, '-', '.'));
+			safe = vorrq_u8(safe, vceqq_u8(x, vdupq_n_u8('!')));
+			safe = vorrq_u8(safe, vceqq_u8(x, vdupq_n_u8('_')));
+			safe = vorrq_u8(safe, vceqq_u8(x, vdupq_n_u8('~')));
+			if (vminvq_u8(safe) == 0) {
+				// The scalar loop below finds the exact position within this block.
+				break;
+			}
+		}
+#endif
+		while (it != end && encodeUriComponentSafeChars[(unsigned char)*it]) {
+			++it;
+		}
+		return it - begin;
+	}
+
+	// Same functionality as JavaScript's encodeURIComponent, passing the result to outfn in pieces.
+	// Keeps alphanumeric (and a few other) characters intact (NOT encoded). See:
+	// https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/encodeURIComponent#description
+	template<typename O>
+	void url_encode(const O& outfn, Span<const char> value) {
+		const char* it = value.begin();
+		const char* end = value.end();
+		while (it != end) {
+			// Runs of safe characters are passed through as they are.
+			const size_t run = safe_run_length(it, end);
+			if (run > 0) {
+				outfn(it, run);
+				it += run;
+				if (it == end) {
+					break;
+				}
+			}
+			// Any other character is percent-encoded.
+			const unsigned char c = *it++;
+			const char escaped[3] = { '%', hexDigitsUpper[c >> 4], hexDigitsUpper[c & 0x0f] };
+			outfn(escaped, 3);
 		}
-		return ss.str();
+	}
+
+	// Calls fn(key, value) for each of the given params (sorted by key) and the custom params
+	// (a Lnurl::Query or Lnurl::FlatQuery), merged in key order.
+	template<typename F, typename C>
+	void merge_params(const F& fn, const ParamRef* params, size_t count, const C &custom) {
+		const ParamRef* param = params;
+		const ParamRef* end = params + count;
+		for_each_param(custom, [&](Span<const char> key, Span<const char> value) {
+			for (; param != end && compare_keys(key, Span<const char>(param->key, strlen(param->key))) > 0; ++param) {
+				fn(Span<const char>(param->key, strlen(param->key)), param->value);
+			}
+			fn(key, value);
+		});
+		for (; param != end; ++param) {
+			fn(Span<const char>(param->key, strlen(param->key)), param->value);
+		}
+	}
+
+	// Stringifies the query made of the given params and the custom params (see merge_params),
+	// passing the result to outfn in pieces, without building the query or the string.
+	// The query must be stringified in this standardized way to ensure consistent signing
+	// between device and server.
+	template<typename O, typename C>
+	void stringify_params(const O& outfn, const ParamRef* params, size_t count, const C &custom) {
+		bool first = true;
+		merge_params([&](Span<const char> key, Span<const char> value) {
+			if (!first) {
+				outfn("&", 1);
+			}
+			first = false;
+			url_encode(outfn, key);
+			outfn("=", 1);
+			url_encode(outfn, value);
+		}, params, count, custom);
+	}
+
+	// Collects the reserved lnurl-withdraw params, sorted by key, into out (room for 7 required).
+	// The signature is omitted when it is empty. Returns the number of params.
+	size_t withdraw_params(ParamRef* out, const Lnurl::SignerConfig &config, const Lnurl::WithdrawParams &params, Span<const char> nonce, Span<const char> signature, bool shorten) {
+		size_t count = 0;
+		const char* tag = "withdrawRequest";
+		out[count++] = { shorten ? "pd" : "defaultDescription", params.defaultDescription };
+		out[count++] = { "id", config.apiKey.id };
+		out[count++] = { shorten ? "px" : "maxWithdrawable", params.maxWithdrawable.digits() };
+		out[count++] = { shorten ? "pn" : "minWithdrawable", params.minWithdrawable.digits() };
+		out[count++] = { shorten ? "n" : "nonce", nonce };
+		if (!signature.empty()) {
+			out[count++] = { shorten ? "s" : "signature", signature };
+		}
+		out[count++] = { shorten ? "t" : "tag", shorten ? Span<const char>("w", 1) : Span<const char>(tag, strlen(tag)) };
+		if (shorten) {
+			std::sort(out, out + count, param_ref_less);
+		}
+		return count;
+	}
+
+	// Writes the lower-case hex encoding of a HMAC-SHA256 hash (64 characters).
+	void signature_to_hex(char* out, const unsigned char* hash) {
+		HexEncode(Span<const uint8_t>(hash, CHMAC_SHA256::OUTPUT_SIZE), Span<char>(out, 2 * CHMAC_SHA256::OUTPUT_SIZE));
+	}
+
+	// Placeholders for the per-URL values of a signing template, recognized by their address.
+	const char templateNonce[1] = { 'n' };
+	const char templateSignature[2 * CHMAC_SHA256::OUTPUT_SIZE] = { 's' };
+
+	// Stringifies the params like stringify_params, but splits the result into consecutive pieces
+	// at the values of the template placeholders, which are left out.
+	template<typename C>
+	void split_params(std::string* pieces, const ParamRef* params, size_t count, const C &custom) {
+		std::string* piece = pieces;
+		const auto append = [&](const char* s, size_t n) {
+			piece->append(s, n);
+		};
+		bool first = true;
+		merge_params([&](Span<const char> key, Span<const char> value) {
+			if (!first) {
+				append("&", 1);
+			}
+			first = false;
+			url_encode(append, key);
+			append("=", 1);
+			if (value.data() == templateNonce || value.data() == templateSignature) {
+				++piece;
+				return;
+			}
+			url_encode(append, value);
+		}, params, count, custom);
+	}
+
+	// Sink which writes into a fixed-size buffer, keeping the last character for the NUL terminator.
+	class BufferWriter {
+		public:
+			BufferWriter(Span<char> t_output) : output(t_output), pos(t_output.begin()) {
+				end = output.empty() ? pos : output.end() - 1;
+				overflow = output.empty();
+			}
+			void write(const char* s, size_t n) {
+				if (overflow || n > size_t(end - pos)) {
+					overflow = true;
+					return;
+				}
+				memcpy(pos, s, n);
+				pos += n;
+			}
+			// Where the next write goes (only meaningful until an overflow).
+			char* position() const {
+				return pos;
+			}
+			bool overflowed() const {
+				return overflow;
+			}
+			// NUL-terminates the output and stores its length, unless the output didn't fit.
+			Lnurl::Status finish(size_t &length) {
+				if (overflow) {
+					return Lnurl::Status::UrlBufferTooSmall;
+				}
+				*pos = '\0';
+				length = pos - output.begin();
+				return Lnurl::Status::Ok;
+			}
+		private:
+			Span<char> output;
+			char* pos;
+			char* end;
+			bool overflow;
+	};
+
+	// Sink which Bech32-encodes into a fixed-size buffer as the LNURL, keeping the last
+	// character for the NUL terminator.
+	class LnurlWriter {
+		public:
+			LnurlWriter(Span<char> t_output, bool uppercase) :
+				output(t_output),
+				encoder(t_output.empty() ? t_output : t_output.first(t_output.size() - 1), Span<const char>("lnurl", 5), uppercase) {}
+			void write(const char* s, size_t n) {
+				encoder.Update(Span<const uint8_t>(UCharCast(s), n));
+			}
+			// NUL-terminates the output and stores its length, unless the output didn't fit.
+			Lnurl::Status finish(size_t &length) {
+				const size_t t_length = encoder.Finish();
+				if (t_length == 0) {
+					return Lnurl::Status::UrlBufferTooSmall;
+				}
+				output[t_length] = '\0';
+				length = t_length;
+				return Lnurl::Status::Ok;
+			}
+		private:
+			Span<char> output;
+			bech32::StreamEncoder encoder;
+	};
+
+	Lnurl::Status check_nonce(Lnurl::StringView nonce) {
+		return nonce.empty() ? Lnurl::Status::MissingNonce : Lnurl::Status::Ok;
+	}
+
+#ifndef LNURL_NO_EXCEPTIONS
+	// Throws the std::invalid_argument of an error status. The params (if any) are those
+	// which failed validation, so that a reserved custom key can be named.
+	void throw_if_error(Lnurl::Status status, const Lnurl::WithdrawParams* params = nullptr) {
+		if (status == Lnurl::Status::Ok) {
+			return;
+		}
+		if (status == Lnurl::Status::ReservedCustomParamKey && params != nullptr) {
+			for (auto const &it : params->custom) {
+				if (find_reserved_key(it.first) != nullptr) {
+					throw std::invalid_argument("Invalid custom parameter key (\"" + it.first + "\"): Reserved");
+				}
+			}
+		}
+		throw std::invalid_argument(Lnurl::status_message(status));
+	}
+#endif
+
+	// Passes the signed lnurl-withdraw URL to outfn in pieces.
+	template<typename O>
+	void write_withdraw_url(const O& outfn, const Lnurl::SignerConfig &config, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce, Span<const char> signature) {
+		ParamRef fixed[7];
+		const size_t count = withdraw_params(fixed, config, params, nonce, signature, config.shorten);
+		outfn(config.callbackUrl.data(), config.callbackUrl.size());
+		outfn("?", 1);
+		stringify_params(outfn, fixed, count, params.custom);
 	}
 }
 
@@ -49,194 +429,855 @@ namespace Lnurl {
 
 	const std::string hrp = "lnurl";
 
-	std::string encode(const std::string &unencoded) {
-		std::vector<uint8_t> v = ParseHex(string_to_hex(unencoded));
-		std::vector<unsigned char> tmp = {};
-		tmp.reserve(1 + 32 * 8 / 5);
-		ConvertBits<8, 5, true>([&](unsigned char c) { tmp.push_back(c); }, v.begin(), v.end());
-		return bech32::Encode(hrp, tmp);
+	std::string encode(Lnurl::StringView unencoded, bool uppercase) {
+		std::string encoded(bech32::EncodedBytesLength(hrp.size(), unencoded.size()), '\0');
+		bech32::EncodeBytes(Span<char>(&encoded[0], encoded.size()), hrp, MakeUCharSpan(unencoded), uppercase);
+		return encoded;
+	}
+
+	std::string decode(Lnurl::StringView encoded) {
+		// The values are decoded into the result, and converted to bytes in place.
+		std::string decodedHrp(encoded.size(), '\0');
+		std::string decoded(encoded.size(), '\0');
+		uint8_t* values = reinterpret_cast<uint8_t*>(&decoded[0]);
+		size_t hrpLength, valuesLength;
+		if (
+			!bech32::Decode(encoded, Span<char>(&decodedHrp[0], decodedHrp.size()), hrpLength, Span<uint8_t>(values, decoded.size()), valuesLength) ||
+			Span<const char>(decodedHrp.data(), hrpLength) != Span<const char>(hrp) ||
+			!ConvertBits5To8(Span<const uint8_t>(values, valuesLength), Span<uint8_t>(values, valuesLength))
+		) {
+			return "";
+		}
+		decoded.resize(valuesLength * 5 / 8);
+		return decoded;
+	}
+
+	Lnurl::Status encode(Lnurl::Arena &arena, Lnurl::StringView &encoded, Lnurl::StringView unencoded, bool uppercase) {
+		const size_t length = bech32::EncodedBytesLength(hrp.size(), unencoded.size());
+		char* const output = arena.allocate_chars(length + 1);
+		if (output == nullptr) {
+			return Lnurl::Status::ArenaExhausted;
+		}
+		bech32::EncodeBytes(Span<char>(output, length), hrp, MakeUCharSpan(unencoded), uppercase);
+		output[length] = '\0';
+		encoded = Lnurl::StringView(output, length);
+		return Lnurl::Status::Ok;
+	}
+
+	Lnurl::Status decode(Lnurl::Arena &arena, Lnurl::StringView &url, Lnurl::StringView encoded) {
+		url = Lnurl::StringView("", 0);
+		// As in decode, the values are converted to bytes in place: the URL is the start of the
+		// values (which are allocated first, unaligned, so that the rest can be freed).
+		const size_t mark = arena.mark();
+		uint8_t* const values = reinterpret_cast<uint8_t*>(arena.allocate_chars(encoded.size()));
+		char* const decodedHrp = arena.allocate_chars(encoded.size());
+		if (values == nullptr || decodedHrp == nullptr) {
+			arena.rewind(mark);
+			return Lnurl::Status::ArenaExhausted;
+		}
+		size_t hrpLength, valuesLength;
+		if (
+			!bech32::Decode(encoded, Span<char>(decodedHrp, encoded.size()), hrpLength, Span<uint8_t>(values, encoded.size()), valuesLength) ||
+			Span<const char>(decodedHrp, hrpLength) != Span<const char>(hrp) ||
+			!ConvertBits5To8(Span<const uint8_t>(values, valuesLength), Span<uint8_t>(values, valuesLength))
+		) {
+			arena.rewind(mark);
+			return Lnurl::Status::Ok;
+		}
+		// There are fewer bytes than values, so the NUL terminator fits.
+		const size_t length = valuesLength * 5 / 8;
+		values[length] = '\0';
+		arena.rewind(mark + length + 1);
+		url = Lnurl::StringView(reinterpret_cast<const char*>(values), length);
+		return Lnurl::Status::Ok;
+	}
+
+	std::vector<Lnurl::DecodeResult> decode_batch(const std::vector<std::string> &encoded) {
+		const std::vector<Lnurl::StringView> views(encoded.begin(), encoded.end());
+		return decode_batch(views);
+	}
+
+	std::vector<Lnurl::DecodeResult> decode_batch(Span<const Lnurl::StringView> encoded) {
+		std::vector<Lnurl::DecodeResult> results(encoded.size());
+		// The HRPs and values of each group of strings are decoded into one buffer, and the
+		// values are converted straight into the URLs.
+		std::vector<char> hrps;
+		std::vector<uint8_t> values;
+		for (size_t first = 0; first < encoded.size(); first += bech32::CHECKSUM_LANES) {
+			const size_t count = std::min(bech32::CHECKSUM_LANES, encoded.size() - first);
+			size_t total = 0;
+			for (size_t i = 0; i < count; i++) {
+				total += encoded[first + i].size();
+			}
+			hrps.resize(std::max(hrps.size(), total));
+			values.resize(std::max(values.size(), total));
+			Span<const char> t_encoded[bech32::CHECKSUM_LANES];
+			Span<char> t_hrps[bech32::CHECKSUM_LANES];
+			Span<uint8_t> t_values[bech32::CHECKSUM_LANES];
+			size_t hrpLengths[bech32::CHECKSUM_LANES];
+			size_t valuesLengths[bech32::CHECKSUM_LANES];
+			size_t offset = 0;
+			for (size_t i = 0; i < count; i++) {
+				const Lnurl::StringView &str = encoded[first + i];
+				t_encoded[i] = str;
+				t_hrps[i] = Span<char>(hrps.data() + offset, str.size());
+				t_values[i] = Span<uint8_t>(values.data() + offset, str.size());
+				offset += str.size();
+			}
+			const unsigned decoded = bech32::DecodeLanes(t_encoded, count, t_hrps, hrpLengths, t_values, valuesLengths);
+			for (size_t i = 0; i < count; i++) {
+				if (!(decoded & (1u << i)) || t_hrps[i].first(hrpLengths[i]) != Span<const char>(hrp)) {
+					continue;
+				}
+				Lnurl::DecodeResult &result = results[first + i];
+				result.url.resize(valuesLengths[i] * 5 / 8);
+				result.valid = ConvertBits5To8(t_values[i].first(valuesLengths[i]), Span<uint8_t>(reinterpret_cast<uint8_t*>(&result.url[0]), result.url.size()));
+				if (!result.valid) {
+					result.url.clear();
+				}
+			}
+		}
+		return results;
+	}
+
+#ifndef LNURL_NO_EXCEPTIONS
+	size_t Decoder::update(Span<const char> chunk, Span<char> output) {
+		size_t length;
+		throw_if_error(update(chunk, output, length));
+		return length;
+	}
+#endif
+
+	Lnurl::Status Decoder::update(Span<const char> chunk, Span<char> output, size_t &length) {
+		if (output.size() < max_output(chunk.size())) {
+			return Lnurl::Status::ChunkBufferTooSmall;
+		}
+		length = 0;
+		uint8_t values[64];
+		while (!chunk.empty() && !decoder.Failed()) {
+			const size_t count = std::min(chunk.size(), sizeof(values));
+			const size_t valueCount = decoder.Update(chunk.first(count), values);
+			chunk = chunk.subspan(count);
+			for (size_t i = 0; i < valueCount; i++) {
+				bits = (bits << 5 | values[i]) & 0xfff;
+				bitCount += 5;
+				if (bitCount >= 8) {
+					bitCount -= 8;
+					output[length++] = static_cast<char>(bits >> bitCount);
+				}
+			}
+		}
+		if (decoder.Failed()) {
+			length = 0;
+		}
+		return Lnurl::Status::Ok;
+	}
+
+	bool Decoder::finish() {
+		// Like ConvertBits<5, 8, false>: less than a value of padding, all zeros.
+		return decoder.Finish() && decoder.Hrp() == Span<const char>(Lnurl::hrp) && bitCount < 5 && (bits & ((1 << bitCount) - 1)) == 0;
 	}
 
-	std::string decode(const std::string &encoded) {
-		const std::pair<std::string, std::vector<uint8_t>> decoded = bech32::Decode(encoded);
-		std::vector<unsigned char> ret;
-		ret.reserve((decoded.second.size() * 5) / 8);
-		ConvertBits<5, 8, false>([&](unsigned char c) { ret.push_back(c); }, decoded.second.begin(), decoded.second.end());
-		return std::string(ret.begin(), ret.end());
+	bool Decoder::failed() const {
+		return decoder.Failed();
 	}
 
+	Span<const char> Decoder::hrp() const {
+		return decoder.Hrp();
+	}
+
+	void Decoder::reset() {
+		decoder.Reset();
+		bits = 0;
+		bitCount = 0;
+	}
+
+	Amount::Amount(const std::string &t_value) {
+		if (t_value.empty()) {
+			return;
+		}
+		int64_t t_msat;
+		// Integers are parsed over the full int64_t range. Anything else must still be a
+		// whole number of msat (within +/-10^18).
+		if (ParseInt64(t_value, &t_msat) || ParseFixedPoint(t_value, 0, &t_msat)) {
+			set_msat(t_msat);
+		} else {
+			state = State::Invalid;
+		}
+	};
+
+	Amount::Amount(const char *t_value) : Amount(std::string(t_value)) {};
+
+	bool Amount::is_set() const {
+		return state != State::Unset;
+	};
+
+	bool Amount::is_valid() const {
+		return state == State::Valid;
+	};
+
+	int64_t Amount::get_msat() const {
+		return msat;
+	};
+
+	Span<const char> Amount::digits() const {
+		return Span<const char>(text, length);
+	};
+
+	std::string Amount::to_string() const {
+		return std::string(text, length);
+	};
+
+	void Amount::set_msat(int64_t t_msat) {
+		msat = t_msat;
+		state = State::Valid;
+		// Written backwards from the end of the buffer, then moved to the front.
+		char* const end = text + MAX_DIGITS;
+		char* pos = end;
+		uint64_t magnitude = t_msat < 0 ? 0 - static_cast<uint64_t>(t_msat) : static_cast<uint64_t>(t_msat);
+		do {
+			*--pos = '0' + magnitude % 10;
+			magnitude /= 10;
+		} while (magnitude);
+		if (t_msat < 0) {
+			*--pos = '-';
+		}
+		length = end - pos;
+		memmove(text, pos, length);
+	};
+
+	FlatQuery::FlatQuery(const Lnurl::Query &query) {
+		// The map is already sorted by key.
+		for (auto const &it : query) {
+			const Param param = { store(it.first), (uint32_t)it.first.size(), store(it.second), (uint32_t)it.second.size() };
+			params.push_back(param);
+		}
+	};
+
+	void FlatQuery::set(Span<const char> key, Span<const char> value) {
+		const size_t i = lower_bound(*this, key);
+		if (i < params.size() && compare_keys(this->key(i), key) == 0) {
+			// The previous value is left unused in the character buffer.
+			params[i].value = store(value);
+			params[i].valueLength = value.size();
+			return;
+		}
+		const uint32_t t_key = store(key);
+		const Param param = { t_key, (uint32_t)key.size(), store(value), (uint32_t)value.size() };
+		params.insert(i, param);
+	};
+
+	void FlatQuery::set(const char *key, const char *value) {
+		set(Span<const char>(key, strlen(key)), Span<const char>(value, strlen(value)));
+	};
+
+	size_t FlatQuery::find(Span<const char> key) const {
+		const size_t i = lower_bound(*this, key);
+		if (i < params.size() && compare_keys(this->key(i), key) == 0) {
+			return i;
+		}
+		return params.size();
+	};
+
+	size_t FlatQuery::size() const {
+		return params.size();
+	};
+
+	bool FlatQuery::empty() const {
+		return params.empty();
+	};
+
+	void FlatQuery::clear() {
+		params.clear();
+		chars.clear();
+	};
+
+	Span<const char> FlatQuery::key(size_t i) const {
+		return Span<const char>(chars.data() + params[i].key, params[i].keyLength);
+	};
+
+	Span<const char> FlatQuery::value(size_t i) const {
+		return Span<const char>(chars.data() + params[i].value, params[i].valueLength);
+	};
+
+	uint32_t FlatQuery::store(Span<const char> text) {
+		const uint32_t offset = chars.size();
+		if (text.data() >= chars.begin() && text.data() < chars.end()) {
+			// The text is already in the buffer (e.g. another param's key), which may move when it grows.
+			const size_t from = text.data() - chars.begin();
+			chars.reserve(chars.size() + text.size());
+			chars.append(chars.data() + from, text.size());
+		} else {
+			chars.append(text.data(), text.size());
+		}
+		return offset;
+	};
+
+#ifndef LNURL_NO_EXCEPTIONS
 	Signer::Signer(SignerConfig t_config) {
-		set_config(t_config);
+		throw_if_error(set_config(t_config));
 	};
+#endif
 
-	void Signer::set_config(SignerConfig t_config) {
+	Lnurl::Status Signer::set_config(const SignerConfig &t_config) {
 		// Encoding equal to "hex", "base64", or "" (unspecified) are permitted.
 		if (
 			t_config.apiKey.encoding != "hex" &&
 			t_config.apiKey.encoding != "base64" &&
 			t_config.apiKey.encoding != ""
 		) {
-			throw std::invalid_argument("Invalid config (\"apiKey.encoding\"): Unsupported encoding - \"hex\", \"base64\", or \"\" are permitted.");
+			return Lnurl::Status::UnsupportedKeyEncoding;
+		}
+		// Decode the key and absorb the HMAC pads once, instead of for every signature.
+		std::vector<unsigned char> key;
+		if (t_config.apiKey.encoding == "hex") {
+			// Hex-encoded key.
+			key = ParseHex(t_config.apiKey.key);
+		} else if (t_config.apiKey.encoding == "base64") {
+			// Base64 encoded key.
+			key = DecodeBase64(t_config.apiKey.key.c_str());
+		} else {
+			// Unspecified encoding.
+			key.assign(t_config.apiKey.key.begin(), t_config.apiKey.key.end());
 		}
+		hasher = CHMAC_SHA256(key.data(), key.size());
 		config = t_config;
+		configured = true;
+		return Lnurl::Status::Ok;
 	};
 
-	// Same functionality as JavaScript's encodeURIComponent.
-	// Keeps alphanumeric (and a few other) characters intact (NOT encoded). See:
-	// https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/encodeURIComponent#description
-	std::string Signer::url_encode(const std::string &value) {
-		std::ostringstream escaped;
-		escaped.fill('0');
-		escaped << std::hex;
-		for (std::string::const_iterator i = value.begin(), n = value.end(); i != n; ++i) {
-			std::string::value_type c = (*i);
-			// Keep alphanumeric and other accepted characters intact.
-			if (encodeUriComponentSafeChars.find(c) != std::string::npos) {
-				escaped << c;
-				continue;
-			}
-			// Any other characters are percent-encoded.
-			escaped << std::uppercase;
-			escaped << '%' << std::setw(2) << int((unsigned char) c);
-			escaped << std::nouppercase;
-		}
-		return escaped.str();
+	bool Signer::is_reserved_param_key(const std::string &paramKey) const {
+		return find_reserved_key(paramKey) != nullptr;
+	};
+
+	Lnurl::Status Signer::validate_params(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		const Lnurl::Status status = check_nonce(nonce);
+		return status != Lnurl::Status::Ok ? status : validate_params(params);
 	};
 
-	bool Signer::is_reserved_param_key(const std::string &paramKey) {
-		for (auto const &it : shortenKeysLookupTable) {
-			std::string key = it.first;
-			std::string value = it.second;
-			if (paramKey == key || paramKey == value) {
-				return true;
+	Lnurl::Status Signer::validate_params(const Lnurl::WithdrawParams &params) const {
+		if (!configured) {
+			return Lnurl::Status::NotConfigured;
+		}
+		if (!params.minWithdrawable.is_set()) {
+			return Lnurl::Status::MissingMinWithdrawable;
+		}
+		if (!params.maxWithdrawable.is_set()) {
+			return Lnurl::Status::MissingMaxWithdrawable;
+		}
+		if (!params.minWithdrawable.is_valid()) {
+			return Lnurl::Status::InvalidMinWithdrawable;
+		}
+		if (!params.maxWithdrawable.is_valid()) {
+			return Lnurl::Status::InvalidMaxWithdrawable;
+		}
+		if (params.minWithdrawable.get_msat() < 0) {
+			return Lnurl::Status::NegativeMinWithdrawable;
+		}
+		if (params.maxWithdrawable.get_msat() < params.minWithdrawable.get_msat()) {
+			return Lnurl::Status::MaxWithdrawableBelowMin;
+		}
+		for (auto const &it : params.custom) {
+			if (is_reserved_param_key(it.first)) {
+				return Lnurl::Status::ReservedCustomParamKey;
 			}
 		}
-		return false;
+		return Lnurl::Status::Ok;
 	};
 
-	std::string Signer::create_signature(const std::string &t_data) {
-		std::vector<unsigned char> data = ParseHex(string_to_hex(t_data));
-		std::vector<unsigned char> key;
-		if (config.apiKey.encoding == "hex") {
-			// Hex-encoded key.
-			key = ParseHex(config.apiKey.key);
-		} else if (config.apiKey.encoding == "base64") {
-			// Base64 encoded key.
-			key = ParseHex(string_to_hex(DecodeBase64(config.apiKey.key)));
-		} else if (config.apiKey.encoding == "") {
-			// Unspecified encoding.
-			key = ParseHex(string_to_hex(config.apiKey.key));
-		} else {
-			// This should never happen.
-			throw std::logic_error("Invalid config (\"apiKey.encoding\"): Unsupported encoding - \"hex\", \"base64\", or \"\" are permitted.");
+	std::string Signer::create_signature(Lnurl::StringView t_data) const {
+		if (!configured) {
+#ifndef LNURL_NO_EXCEPTIONS
+			throw_if_error(Lnurl::Status::NotConfigured);
+#endif
+			return "";
 		}
-		std::vector<unsigned char> signature;
-		signature.resize(32);
-		CHMAC_SHA256 hasher = CHMAC_SHA256(key.data(), key.size());
-		hasher.Write((unsigned char*)&data[0], data.size());
-		hasher.Finalize(&signature[0]);
-		return HexStr(signature);
+		unsigned char hash[CHMAC_SHA256::OUTPUT_SIZE];
+		CHMAC_SHA256 t_hasher = hasher;
+		t_hasher.Write(UCharCast(t_data.data()), t_data.size());
+		t_hasher.Finalize(hash);
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+		signature_to_hex(signature, hash);
+		return std::string(signature, sizeof(signature));
 	};
 
-	Lnurl::Query Signer::shorten_query(const Lnurl::Query &query) {
-		Lnurl::Query shortenedQuery;
-		for (auto const &it : query) {
-			std::string key = it.first;
-			std::string value = it.second;
-			if (key == "tag") {
-				const auto shortTag = shortenTagsLookupTable.find(value);
-				if (shortTag != shortenTagsLookupTable.end()) {
-					value = shortTag->second;
+	Lnurl::FlatQuery Signer::shorten_query(const Lnurl::FlatQuery &query) const {
+		Lnurl::FlatQuery shortenedQuery;
+		for (size_t i = 0; i < query.size(); ++i) {
+			Span<const char> key = query.key(i);
+			Span<const char> value = query.value(i);
+			const ReservedKey* reserved = find_reserved_key(key);
+			if (reserved != nullptr) {
+				if (strcmp(reserved->key, "tag") == 0 && compare_keys(value, Span<const char>("withdrawRequest", 15)) == 0) {
+					value = Span<const char>("w", 1);
 				}
+				key = Span<const char>(reserved->shortKey, strlen(reserved->shortKey));
 			}
-			const auto shortKey = shortenKeysLookupTable.find(key);
-			if (shortKey != shortenKeysLookupTable.end()) {
-				key = shortKey->second;
-			}
-			shortenedQuery[key] = value;
+			shortenedQuery.set(key, value);
 		}
 		return shortenedQuery;
 	};
 
-	std::string Signer::stringify_query(const Lnurl::Query &query) {
-		std::string str = "";
-		// The default behavior of std::map is to sort alphabetically on the first element.
-		// In this case the first element is the query parameter's key.
-		// No extra sorting is required here.
-		for (auto const &it : query) {
-			std::string key = it.first;
-			std::string value = it.second;
-			str += "&";
-			str += url_encode(key);
-			str += "=";
-			str += url_encode(value);
+	std::string Signer::create_url(const Lnurl::Query &t_query) const {
+		return create_url(Lnurl::FlatQuery(t_query));
+	};
+
+	std::string Signer::create_url(const Lnurl::FlatQuery &t_query) const {
+		if (!configured) {
+#ifndef LNURL_NO_EXCEPTIONS
+			throw_if_error(Lnurl::Status::NotConfigured);
+#endif
+			return "";
+		}
+		unsigned char hash[CHMAC_SHA256::OUTPUT_SIZE];
+		CHMAC_SHA256 t_hasher = hasher;
+		stringify_params([&](const char* s, size_t n) { t_hasher.Write(UCharCast(s), n); }, nullptr, 0, t_query);
+		t_hasher.Finalize(hash);
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+		signature_to_hex(signature, hash);
+		Lnurl::FlatQuery query = t_query;
+		query.set(Span<const char>("signature", 9), signature);
+		if (config.shorten) {
+			query = shorten_query(query);
+		}
+		std::string url = config.callbackUrl;
+		url += "?";
+		stringify_params([&](const char* s, size_t n) { url.append(s, n); }, nullptr, 0, query);
+		return url;
+	};
+
+#ifndef LNURL_NO_EXCEPTIONS
+	std::string Signer::create_url(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		std::string url;
+		throw_if_error(create_url(url, params, nonce), &params);
+		return url;
+	};
+
+	size_t Signer::url_length(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		size_t length;
+		throw_if_error(url_length(length, params, nonce), &params);
+		return length;
+	};
+
+	size_t Signer::create_url(Span<char> output, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		size_t length;
+		throw_if_error(create_url(output, length, params, nonce), &params);
+		return length;
+	};
+#endif
+
+	Lnurl::Status Signer::create_url(std::string &url, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		size_t length;
+		const Lnurl::Status status = url_length(length, params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		url.resize(length + 1);
+		create_url(Span<char>(&url[0], url.size()), length, params, nonce);
+		url.resize(length);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status Signer::create_url(Lnurl::Arena &arena, Lnurl::StringView &url, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		size_t length;
+		const Lnurl::Status status = url_length(length, params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		// Erase the first delimiter.
-		if (str != "") {
-			str.erase(0, 1);
+		char* const output = arena.allocate_chars(length + 1);
+		if (output == nullptr) {
+			return Lnurl::Status::ArenaExhausted;
 		}
-		return str;
+		create_url(Span<char>(output, length + 1), length, params, nonce);
+		url = Lnurl::StringView(output, length);
+		return Lnurl::Status::Ok;
 	};
 
-	void Signer::sign_query(Lnurl::Query &query) {
-		// The query object should be stringified in a standardized way.
-		// This is needed to ensure consistent signing between device and server.
-		const std::string payload = stringify_query(query);
-		const std::string signature = create_signature(payload);
-		query["signature"] = signature;
+	Lnurl::Status Signer::url_length(size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		const Lnurl::Status status = validate_params(params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		// The signature is always 64 hex characters, so its value doesn't matter here.
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+		memset(signature, '0', sizeof(signature));
+		length = 0;
+		write_withdraw_url([&](const char*, size_t n) { length += n; }, config, params, nonce, signature);
+		return Lnurl::Status::Ok;
 	};
 
-	std::string Signer::create_url(const Lnurl::Query &t_query) {
-		std::string url = "";
-		url += config.callbackUrl;
-		Lnurl::Query query = t_query;
-		sign_query(query);
+	Lnurl::Status Signer::create_url(Span<char> output, size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		const Lnurl::Status status = validate_params(params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		BufferWriter writer(output);
+		const auto write = [&](const char* s, size_t n) {
+			writer.write(s, n);
+		};
+		CHMAC_SHA256 t_hasher = hasher;
+		const auto hash = [&](const char* s, size_t n) {
+			t_hasher.Write(UCharCast(s), n);
+		};
+		unsigned char digest[CHMAC_SHA256::OUTPUT_SIZE];
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
 		if (config.shorten) {
-			query = shorten_query(query);
+			// The signed payload uses the full keys, which sort differently from the shortened
+			// keys of the URL, so the payload is hashed before the URL is written.
+			ParamRef fixed[7];
+			const size_t count = withdraw_params(fixed, config, params, nonce, Span<const char>(), false);
+			stringify_params(hash, fixed, count, params.custom);
+			t_hasher.Finalize(digest);
+			signature_to_hex(signature, digest);
+			write_withdraw_url(write, config, params, nonce, signature);
+		} else {
+			// Single pass: each param is URL-encoded once, into both the URL and the hasher.
+			// The signature (which isn't part of the payload) is written as a placeholder and
+			// filled in once the hash is known.
+			memset(signature, '0', sizeof(signature));
+			char* signaturePos = nullptr;
+			ParamRef fixed[7];
+			const size_t count = withdraw_params(fixed, config, params, nonce, signature, false);
+			write(config.callbackUrl.data(), config.callbackUrl.size());
+			write("?", 1);
+			bool first = true;
+			bool firstSigned = true;
+			const auto both = [&](const char* s, size_t n) {
+				write(s, n);
+				hash(s, n);
+			};
+			merge_params([&](Span<const char> key, Span<const char> value) {
+				const bool isSignature = value.data() == signature;
+				if (!first) {
+					write("&", 1);
+				}
+				if (!firstSigned && !isSignature) {
+					hash("&", 1);
+				}
+				first = false;
+				if (isSignature) {
+					url_encode(write, key);
+					write("=", 1);
+					signaturePos = writer.position();
+					write(signature, sizeof(signature));
+					return;
+				}
+				firstSigned = false;
+				url_encode(both, key);
+				both("=", 1);
+				url_encode(both, value);
+			}, fixed, count, params.custom);
+			t_hasher.Finalize(digest);
+			if (!writer.overflowed()) {
+				signature_to_hex(signaturePos, digest);
+			}
 		}
-		url += "?" + stringify_query(query);
+		return writer.finish(length);
+	};
+
+#ifndef LNURL_NO_EXCEPTIONS
+	std::string Signer::create_lnurl(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce, bool uppercase) const {
+		std::string lnurl;
+		throw_if_error(create_lnurl(lnurl, params, nonce, uppercase), &params);
+		return lnurl;
+	};
+#endif
+
+	Lnurl::Status Signer::create_lnurl(std::string &lnurl, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce, bool uppercase) const {
+		size_t length;
+		const Lnurl::Status status = lnurl_length(length, params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		lnurl.resize(length + 1);
+		create_lnurl(Span<char>(&lnurl[0], lnurl.size()), length, params, nonce, uppercase);
+		lnurl.resize(length);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status Signer::lnurl_length(size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const {
+		size_t urlLength;
+		const Lnurl::Status status = url_length(urlLength, params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		length = bech32::EncodedBytesLength(hrp.size(), urlLength);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status Signer::create_lnurl(Span<char> output, size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce, bool uppercase) const {
+		const Lnurl::Status status = validate_params(params, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		// Encoded characters can't be filled in later (as create_url does with the signature),
+		// so the payload is hashed first and the URL is then encoded as it's written.
+		CHMAC_SHA256 t_hasher = hasher;
+		ParamRef fixed[7];
+		const size_t count = withdraw_params(fixed, config, params, nonce, Span<const char>(), false);
+		stringify_params([&](const char* s, size_t n) { t_hasher.Write(UCharCast(s), n); }, fixed, count, params.custom);
+		unsigned char digest[CHMAC_SHA256::OUTPUT_SIZE];
+		t_hasher.Finalize(digest);
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+		signature_to_hex(signature, digest);
+		LnurlWriter writer(output, uppercase);
+		write_withdraw_url([&](const char* s, size_t n) { writer.write(s, n); }, config, params, nonce, signature);
+		return writer.finish(length);
+	};
+
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SigningTemplate Signer::create_template(const Lnurl::WithdrawParams &params) const {
+		Lnurl::SigningTemplate t_template;
+		throw_if_error(create_template(t_template, params), &params);
+		return t_template;
+	};
+#endif
+
+	Lnurl::Status Signer::create_template(Lnurl::SigningTemplate &t_template, const Lnurl::WithdrawParams &params) const {
+		const Lnurl::Status status = validate_params(params);
+		if (status != Lnurl::Status::Ok) {
+			return status;
+		}
+		// Signed payload: hash the part before the nonce now, keep the rest for each URL.
+		ParamRef fixed[7];
+		size_t count = withdraw_params(fixed, config, params, templateNonce, Span<const char>(), false);
+		std::string payload[2];
+		split_params(payload, fixed, count, params.custom);
+		CHMAC_SHA256 t_hasher = hasher;
+		t_hasher.Write(UCharCast(payload[0].data()), payload[0].size());
+		t_hasher.GetMidstate(t_template.midstate);
+		t_template.payloadSuffix = payload[1];
+		// URL: pre-render everything around the nonce and the signature.
+		count = withdraw_params(fixed, config, params, templateNonce, templateSignature, config.shorten);
+		std::string url[3];
+		url[0] = config.callbackUrl + "?";
+		split_params(url, fixed, count, params.custom);
+		t_template.urlPrefix = url[0];
+		t_template.urlMiddle = url[1];
+		t_template.urlSuffix = url[2];
+		t_template.prepared = true;
+		return Lnurl::Status::Ok;
+	};
+
+#ifndef LNURL_NO_EXCEPTIONS
+	std::string SigningTemplate::create_url(Lnurl::StringView nonce) const {
+		std::string url;
+		throw_if_error(create_url(url, nonce));
 		return url;
 	};
 
-	std::string Signer::create_url(const Lnurl::WithdrawParams &params, const std::string &nonce) {
-		if (nonce == "") {
-			throw std::invalid_argument("Missing required argument: \"nonce\"");
+	size_t SigningTemplate::url_length(Lnurl::StringView nonce) const {
+		size_t length;
+		throw_if_error(url_length(length, nonce));
+		return length;
+	};
+
+	size_t SigningTemplate::create_url(Span<char> output, Lnurl::StringView nonce) const {
+		size_t length;
+		throw_if_error(create_url(output, length, nonce));
+		return length;
+	};
+#endif
+
+	Lnurl::Status SigningTemplate::create_url(std::string &url, Lnurl::StringView nonce) const {
+		size_t length;
+		const Lnurl::Status status = url_length(length, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		if (params.minWithdrawable == "") {
-			throw std::invalid_argument("Missing required parameter: \"minWithdrawable\"");
+		url.resize(length + 1);
+		create_url(Span<char>(&url[0], url.size()), length, nonce);
+		url.resize(length);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status SigningTemplate::create_url(Lnurl::Arena &arena, Lnurl::StringView &url, Lnurl::StringView nonce) const {
+		size_t length;
+		const Lnurl::Status status = url_length(length, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		if (params.maxWithdrawable == "") {
-			throw std::invalid_argument("Missing required parameter: \"maxWithdrawable\"");
+		char* const output = arena.allocate_chars(length + 1);
+		if (output == nullptr) {
+			return Lnurl::Status::ArenaExhausted;
 		}
-		const double minWithdrawable = std::stod(params.minWithdrawable);
-		const double maxWithdrawable = std::stod(params.maxWithdrawable);
-		if (std::isnan(minWithdrawable)) {
-			throw std::invalid_argument("\"minWithdrawable\" must be a number");
+		create_url(Span<char>(output, length + 1), length, nonce);
+		url = Lnurl::StringView(output, length);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status SigningTemplate::validate_nonce(Lnurl::StringView nonce) const {
+		return prepared ? check_nonce(nonce) : Lnurl::Status::TemplateNotPrepared;
+	};
+
+	Lnurl::Status SigningTemplate::url_length(size_t &length, Lnurl::StringView nonce) const {
+		const Lnurl::Status status = validate_nonce(nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		if (std::isnan(maxWithdrawable)) {
-			throw std::invalid_argument("\"maxWithdrawable\" must be a number");
+		length = urlPrefix.size() + urlMiddle.size() + 2 * CHMAC_SHA256::OUTPUT_SIZE + urlSuffix.size();
+		url_encode([&](const char*, size_t n) { length += n; }, nonce);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status SigningTemplate::create_url(Span<char> output, size_t &length, Lnurl::StringView nonce) const {
+		const Lnurl::Status status = validate_nonce(nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		if (minWithdrawable < 0) {
-			throw std::invalid_argument("\"minWithdrawable\" must be greater than zero");
+		BufferWriter writer(output);
+		CHMAC_SHA256 t_hasher;
+		t_hasher.SetMidstate(midstate);
+		writer.write(urlPrefix.data(), urlPrefix.size());
+		url_encode([&](const char* s, size_t n) {
+			writer.write(s, n);
+			t_hasher.Write(UCharCast(s), n);
+		}, nonce);
+		t_hasher.Write(UCharCast(payloadSuffix.data()), payloadSuffix.size());
+		unsigned char digest[CHMAC_SHA256::OUTPUT_SIZE];
+		t_hasher.Finalize(digest);
+		writer.write(urlMiddle.data(), urlMiddle.size());
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+		signature_to_hex(signature, digest);
+		writer.write(signature, sizeof(signature));
+		writer.write(urlSuffix.data(), urlSuffix.size());
+		return writer.finish(length);
+	};
+
+	Lnurl::Status SigningTemplate::lnurl_length(size_t &length, Lnurl::StringView nonce) const {
+		size_t urlLength;
+		const Lnurl::Status status = url_length(urlLength, nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		if (maxWithdrawable < minWithdrawable) {
-			throw std::invalid_argument("\"maxWithdrawable\" must be greater than or equal to \"minWithdrawable\"");
+		length = bech32::EncodedBytesLength(hrp.size(), urlLength);
+		return Lnurl::Status::Ok;
+	};
+
+	Lnurl::Status SigningTemplate::create_lnurl(Span<char> output, size_t &length, Lnurl::StringView nonce, bool uppercase) const {
+		const Lnurl::Status status = validate_nonce(nonce);
+		if (status != Lnurl::Status::Ok) {
+			return status;
 		}
-		Lnurl::Query query;
-		query["id"] = config.apiKey.id;
-		query["tag"] = "withdrawRequest";
-		query["nonce"] = nonce;
-		query["minWithdrawable"] = params.minWithdrawable;
-		query["maxWithdrawable"] = params.maxWithdrawable;
-		query["defaultDescription"] = params.defaultDescription;
-		for (auto const &it : params.custom) {
-			std::string customKey = it.first;
-			std::string customValue = it.second;
-			if (is_reserved_param_key(customKey)) {
-				throw std::invalid_argument("Invalid custom parameter key (\"" + customKey + "\"): Reserved");
+		// The signature comes after the nonce, so this is a single pass as in create_url.
+		LnurlWriter writer(output, uppercase);
+		CHMAC_SHA256 t_hasher;
+		t_hasher.SetMidstate(midstate);
+		writer.write(urlPrefix.data(), urlPrefix.size());
+		url_encode([&](const char* s, size_t n) {
+			writer.write(s, n);
+			t_hasher.Write(UCharCast(s), n);
+		}, nonce);
+		t_hasher.Write(UCharCast(payloadSuffix.data()), payloadSuffix.size());
+		unsigned char digest[CHMAC_SHA256::OUTPUT_SIZE];
+		t_hasher.Finalize(digest);
+		writer.write(urlMiddle.data(), urlMiddle.size());
+		char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+		signature_to_hex(signature, digest);
+		writer.write(signature, sizeof(signature));
+		writer.write(urlSuffix.data(), urlSuffix.size());
+		return writer.finish(length);
+	};
+
+	Lnurl::Status Signer::create_url_range(std::vector<std::string> &urls, const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, size_t begin, size_t end, size_t &failed) const {
+		// Payloads are signed in groups, so that their HMACs can be computed in parallel SIMD lanes.
+		static const size_t GROUP = 8;
+		std::string payloads[GROUP];
+		const unsigned char* data[GROUP];
+		size_t len[GROUP];
+		unsigned char hashes[GROUP * CHMAC_SHA256::OUTPUT_SIZE];
+		for (size_t first = begin; first < end; first += GROUP) {
+			const size_t count = std::min(GROUP, end - first);
+			for (size_t i = 0; i < count; ++i) {
+				const Lnurl::WithdrawParams &t_params = params[first + i];
+				const std::string &nonce = nonces[first + i];
+				const Lnurl::Status status = validate_params(t_params, nonce);
+				if (status != Lnurl::Status::Ok) {
+					failed = first + i;
+					return status;
+				}
+				ParamRef fixed[7];
+				const size_t fixedCount = withdraw_params(fixed, config, t_params, nonce, Span<const char>(), false);
+				std::string &payload = payloads[i];
+				payload.clear();
+				stringify_params([&](const char* s, size_t n) { payload.append(s, n); }, fixed, fixedCount, t_params.custom);
+				data[i] = UCharCast(payload.data());
+				len[i] = payload.size();
+			}
+			hasher.FinalizeMulti(hashes, data, len, count);
+			for (size_t i = 0; i < count; ++i) {
+				const Lnurl::WithdrawParams &t_params = params[first + i];
+				const std::string &nonce = nonces[first + i];
+				char signature[2 * CHMAC_SHA256::OUTPUT_SIZE];
+				signature_to_hex(signature, hashes + i * CHMAC_SHA256::OUTPUT_SIZE);
+				std::string &url = urls[first + i];
+				size_t length = 0;
+				write_withdraw_url([&](const char*, size_t n) { length += n; }, config, t_params, nonce, signature);
+				url.reserve(length);
+				write_withdraw_url([&](const char* s, size_t n) { url.append(s, n); }, config, t_params, nonce, signature);
+			}
+		}
+		return Lnurl::Status::Ok;
+	};
+
+#ifndef LNURL_NO_EXCEPTIONS
+	std::vector<std::string> Signer::create_urls(const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, unsigned int threads) const {
+		std::vector<std::string> urls;
+		size_t failed = 0;
+		const Lnurl::Status status = sign_urls(urls, params, nonces, threads, failed);
+		throw_if_error(status, failed < params.size() ? &params[failed] : nullptr);
+		return urls;
+	};
+#endif
+
+	Lnurl::Status Signer::create_urls(std::vector<std::string> &urls, const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, unsigned int threads) const {
+		size_t failed;
+		return sign_urls(urls, params, nonces, threads, failed);
+	};
+
+	Lnurl::Status Signer::sign_urls(std::vector<std::string> &urls, const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, unsigned int threads, size_t &failed) const {
+		failed = params.size();
+		if (!configured) {
+			return Lnurl::Status::NotConfigured;
+		}
+		if (params.size() != nonces.size()) {
+			return Lnurl::Status::NonceCountMismatch;
+		}
+		urls.assign(params.size(), std::string());
+#ifdef LNURL_THREADS
+		if (threads == 0) {
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		threads = std::min<size_t>(threads, params.size());
+		if (threads > 1) {
+			// Each worker signs a contiguous range and writes its results in place.
+			// Each range stops at its first error; the error of the first range (by input order)
+			// which failed is returned after all workers finish.
+			std::vector<Lnurl::Status> errors(threads, Lnurl::Status::Ok);
+			std::vector<size_t> failures(threads);
+			std::vector<std::thread> workers;
+			workers.reserve(threads);
+			for (unsigned int t = 0; t < threads; ++t) {
+				const size_t begin = params.size() * t / threads;
+				const size_t end = params.size() * (t + 1) / threads;
+				workers.emplace_back([this, &params, &nonces, &urls, &errors, &failures, t, begin, end]() {
+					errors[t] = create_url_range(urls, params, nonces, begin, end, failures[t]);
+				});
+			}
+			for (auto &worker : workers) {
+				worker.join();
+			}
+			for (unsigned int t = 0; t < threads; ++t) {
+				if (errors[t] != Lnurl::Status::Ok) {
+					failed = failures[t];
+					return errors[t];
+				}
 			}
-			query[customKey] = customValue;
+			return Lnurl::Status::Ok;
 		}
-		return create_url(query);
+#else
+		(void)threads;
+#endif
+		return create_url_range(urls, params, nonces, 0, params.size(), failed);
 	};
 }
@@ -18,24 +18,125 @@
 #ifndef LNURL_H
 #define LNURL_H
 
+#include "arena.h"
 #include "bech32.h"
 #include "crypto/hmac_sha256.h"
+#include "qrcode.h"
+#include "smallvector.h"
+#include "span.h"
+#include "status.h"
+#include "stringview.h"
 #include "util/strencodings.h"
 
-#include <cmath>
-#include <iomanip>
 #include <map>
-#include <sstream>
 #include <stdexcept>
+#include <stdint.h>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+// Batch signing (Signer::create_urls) is spread over worker threads on hosts.
+// Embedded builds, or builds with LNURL_NO_THREADS defined, sign sequentially.
+//
+// The entry points which can fail throw std::invalid_argument. Each has a counterpart which
+// returns a Lnurl::Status instead, the only one available with LNURL_NO_EXCEPTIONS (see status.h).
+#if !defined(LNURL_NO_THREADS) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define LNURL_THREADS
+#endif
 
 namespace Lnurl {
 
-	std::string encode(const std::string &unencoded);
-	std::string decode(const std::string &encoded);
+	// Uppercase LNURLs are as valid, and fit QR codes in alphanumeric mode (see Lnurl::QrCode).
+	std::string encode(Lnurl::StringView unencoded, bool uppercase = false);
+	// Returns an empty string if encoded isn't a valid LNURL (see DecodeResult).
+	std::string decode(Lnurl::StringView encoded);
+	// Same, with the (NUL-terminated) result allocated from the arena, which also provides the
+	// scratch memory of decode. The URL is empty if encoded isn't a valid LNURL. Returns
+	// Status::ArenaExhausted, and frees what was allocated, if the arena is too small.
+	Lnurl::Status encode(Lnurl::Arena &arena, Lnurl::StringView &encoded, Lnurl::StringView unencoded, bool uppercase = false);
+	Lnurl::Status decode(Lnurl::Arena &arena, Lnurl::StringView &url, Lnurl::StringView encoded);
+
+	struct DecodeResult {
+		// Whether the input was a valid LNURL: a bech32 string with the "lnurl" prefix
+		// (in either case) and valid padding. decode and Decoder::finish() accept the same
+		// strings, so other bech32 strings (e.g. addresses) aren't mistaken for LNURLs.
+		bool valid = false;
+		std::string url;
+	};
+
+	// Decodes (and validates) many LNURLs at once, with the checksums of several of them
+	// computed side by side (see bech32::DecodeLanes). Results are in the same order as the input.
+	std::vector<Lnurl::DecodeResult> decode_batch(const std::vector<std::string> &encoded);
+	std::vector<Lnurl::DecodeResult> decode_batch(Span<const Lnurl::StringView> encoded);
+
+	// Decodes an LNURL which is received in chunks (e.g. over UART, NFC or BLE), without
+	// keeping more than the current chunk in memory, and without a length limit. The URL is
+	// written out as it's decoded, but is only valid once finish() returns true (the
+	// checksum is at the end):
+	//
+	//   Lnurl::Decoder decoder;
+	//   char url[Lnurl::Decoder::max_output(sizeof(chunk))];
+	//   while (...) {
+	//     const size_t length = decoder.update(Span<const char>(chunk, received), url);
+	//   }
+	//   const bool valid = decoder.finish();
+	class Decoder {
+		public:
+			// Most bytes written by update() for a chunk of the given length.
+			static constexpr size_t max_output(size_t chunkLength) { return (chunkLength * 5 + 7) / 8; }
+			#ifndef LNURL_NO_EXCEPTIONS
+			// Decodes the next chunk into output, which must have room for max_output(chunk.size())
+			// bytes. Returns the number of bytes written (0 after a failure, see failed()).
+			size_t update(Span<const char> chunk, Span<char> output);
+			#endif
+			// Same, with the number of bytes written stored in length.
+			Lnurl::Status update(Span<const char> chunk, Span<char> output, size_t &length);
+			// Checks the checksum, the prefix and the padding once all chunks were decoded.
+			// Returns whether the whole input was a valid LNURL (see DecodeResult).
+			bool finish();
+			bool failed() const;
+			// The (lowercase) human-readable part ("lnurl"), once it was decoded.
+			Span<const char> hrp() const;
+			void reset();
+		private:
+			bech32::StreamDecoder decoder;
+			// Bits which don't make a whole byte yet (the lowest bitCount bits of bits).
+			uint32_t bits = 0;
+			int bitCount = 0;
+	};
 
 	typedef std::map<std::string, std::string> Query;
 
+	// Query params sorted by key, like Lnurl::Query, but stored contiguously: the keys and
+	// values share one character buffer. A typical signed lnurl-withdraw query fits in the
+	// inline storage, so building (or copying) one doesn't allocate.
+	class FlatQuery {
+		public:
+			FlatQuery() {}
+			explicit FlatQuery(const Lnurl::Query &query);
+			// Adds the param, or replaces its value if the key is already present.
+			void set(Span<const char> key, Span<const char> value);
+			void set(const char *key, const char *value);
+			// Index of the param with the given key, or size() if there is none.
+			size_t find(Span<const char> key) const;
+			size_t size() const;
+			bool empty() const;
+			void clear();
+			// Params are ordered by key. Only valid until the query is modified.
+			Span<const char> key(size_t i) const;
+			Span<const char> value(size_t i) const;
+		private:
+			struct Param {
+				uint32_t key;
+				uint32_t keyLength;
+				uint32_t value;
+				uint32_t valueLength;
+			};
+			Lnurl::SmallVector<Param, 8> params;
+			Lnurl::SmallVector<char, 384> chars;
+			uint32_t store(Span<const char> text);
+	};
+
 	struct SignerApiKey {
 		std::string id;
 		std::string key;
@@ -53,26 +154,153 @@ namespace Lnurl {
 		Query custom;
 	};
 
+	// Integer types which can be assigned to an Amount: not bool or the character types, whose
+	// values (true, '5') would quietly become msat.
+	template<typename T>
+	struct is_msat_integer : std::integral_constant<bool, std::is_integral<T>::value &&
+		!std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+		!std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+		!std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value &&
+		!std::is_same<T, char32_t>::value> {};
+
+	// An amount in millisatoshis.
+	// Strings are parsed once, when assigned, without floating point: integers ("50000") and
+	// other JSON numbers which are a whole number of msat ("50.00", "5e4") are accepted.
+	// URLs always contain the integer ("50", "50000").
+	class Amount {
+		public:
+			// Longest decimal representation of an int64_t ("-9223372036854775808").
+			static const size_t MAX_DIGITS = 20;
+			Amount() {}
+			// Unsigned values above INT64_MAX are invalid.
+			template<typename T, typename = typename std::enable_if<is_msat_integer<T>::value>::type>
+			Amount(T t_msat) {
+				if (std::is_unsigned<T>::value && static_cast<uint64_t>(t_msat) > static_cast<uint64_t>(INT64_MAX)) {
+					state = State::Invalid;
+				} else {
+					set_msat(static_cast<int64_t>(t_msat));
+				}
+			}
+			Amount(const std::string &t_value);
+			Amount(const char *t_value);
+			// False for a default-constructed or empty amount.
+			bool is_set() const;
+			// False if the amount was assigned a string which is not a whole number of msat.
+			bool is_valid() const;
+			int64_t get_msat() const;
+			// Decimal representation of the amount (not NUL-terminated).
+			Span<const char> digits() const;
+			std::string to_string() const;
+		private:
+			enum class State : uint8_t { Unset, Invalid, Valid };
+			int64_t msat = 0;
+			State state = State::Unset;
+			uint8_t length = 0;
+			char text[MAX_DIGITS];
+			void set_msat(int64_t t_msat);
+	};
+
 	struct WithdrawParams : Params {
-		std::string minWithdrawable;
-		std::string maxWithdrawable;
+		Lnurl::Amount minWithdrawable;
+		Lnurl::Amount maxWithdrawable;
 		std::string defaultDescription = "";
 	};
 
+	// Signs URLs which share all their params but the nonce (e.g. one price per terminal).
+	// The signed payload before the nonce is hashed once, when the template is created by
+	// Signer::create_template, so each URL only hashes the nonce and the rest of the payload.
+	// The template doesn't refer to the signer or the params it was created from. Until
+	// create_template succeeds, its methods return Status::TemplateNotPrepared.
+	class SigningTemplate {
+		public:
+			#ifndef LNURL_NO_EXCEPTIONS
+			// Same as Signer::create_url(params, nonce) for the template's params.
+			std::string create_url(Lnurl::StringView nonce) const;
+			size_t url_length(Lnurl::StringView nonce) const;
+			size_t create_url(Span<char> output, Lnurl::StringView nonce) const;
+			#endif
+			Lnurl::Status create_url(std::string &url, Lnurl::StringView nonce) const;
+			Lnurl::Status url_length(size_t &length, Lnurl::StringView nonce) const;
+			Lnurl::Status create_url(Span<char> output, size_t &length, Lnurl::StringView nonce) const;
+			Lnurl::Status create_url(Lnurl::Arena &arena, Lnurl::StringView &url, Lnurl::StringView nonce) const;
+			// Same as Signer::create_lnurl for the template's params.
+			Lnurl::Status lnurl_length(size_t &length, Lnurl::StringView nonce) const;
+			Lnurl::Status create_lnurl(Span<char> output, size_t &length, Lnurl::StringView nonce, bool uppercase = false) const;
+		private:
+			friend class Signer;
+			// Set once Signer::create_template succeeds.
+			bool prepared = false;
+			Lnurl::Status validate_nonce(Lnurl::StringView nonce) const;
+			// HMAC midstate after the payload before the nonce value.
+			unsigned char midstate[CHMAC_SHA256::MIDSTATE_SIZE];
+			// The payload after the nonce value.
+			std::string payloadSuffix;
+			// The URL before the nonce value, between the nonce value and the signature, and after the signature.
+			std::string urlPrefix;
+			std::string urlMiddle;
+			std::string urlSuffix;
+	};
+
+	// Signs lnurl-withdraw URLs with the key of its config. Once configured, a signer is only
+	// read (its key material is precomputed), so one instance can be shared by many threads,
+	// which sign at the same time without locking. Only set_config must not run concurrently.
 	class Signer {
 		private:
 			Lnurl::SignerConfig config;
-			void set_config(Lnurl::SignerConfig t_config);
-			std::string url_encode(const std::string &value);
-			bool is_reserved_param_key(const std::string &paramKey);
-			Lnurl::Query shorten_query(const Lnurl::Query &query);
-			std::string stringify_query(const Lnurl::Query &query);
-			void sign_query(Lnurl::Query &query);
+			// Keyed HMAC state (inner/outer pads already absorbed). Copied for each signature.
+			CHMAC_SHA256 hasher;
+			// Set once set_config succeeds.
+			bool configured = false;
+			bool is_reserved_param_key(const std::string &paramKey) const;
+			Lnurl::FlatQuery shorten_query(const Lnurl::FlatQuery &query) const;
+			Lnurl::Status validate_params(const Lnurl::WithdrawParams &params) const;
+			Lnurl::Status validate_params(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			Lnurl::Status create_url_range(std::vector<std::string> &urls, const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, size_t begin, size_t end, size_t &failed) const;
+			Lnurl::Status sign_urls(std::vector<std::string> &urls, const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, unsigned int threads, size_t &failed) const;
 		public:
+			// Unusable until set_config succeeds: until then, signing returns Status::NotConfigured
+			// (or throws it), and create_signature and the Query versions of create_url return "".
+			Signer() {}
+			#ifndef LNURL_NO_EXCEPTIONS
 			Signer(Lnurl::SignerConfig t_config);
-			std::string create_signature(const std::string &t_data);
-			std::string create_url(const Lnurl::Query &t_query);
-			std::string create_url(const Lnurl::WithdrawParams &params, const std::string &nonce = "");
+			#endif
+			Lnurl::Status set_config(const Lnurl::SignerConfig &t_config);
+			std::string create_signature(Lnurl::StringView t_data) const;
+			std::string create_url(const Lnurl::Query &t_query) const;
+			std::string create_url(const Lnurl::FlatQuery &t_query) const;
+			#ifndef LNURL_NO_EXCEPTIONS
+			std::string create_url(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce = "") const;
+			// Length of the signed URL (excluding the NUL terminator) that create_url will produce.
+			size_t url_length(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			// Writes the NUL-terminated signed URL into output without allocating. The output
+			// must have room for at least url_length(params, nonce) + 1 characters.
+			// Returns the length of the URL (excluding the NUL terminator).
+			size_t create_url(Span<char> output, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			// Prepares the signing of URLs with the given params and any nonce (see SigningTemplate).
+			Lnurl::SigningTemplate create_template(const Lnurl::WithdrawParams &params) const;
+			// Signs params[i] with nonces[i] for every i. Results are in the same order as the input.
+			// With LNURL_THREADS the work is split over the given number of threads (0 = one per core).
+			std::vector<std::string> create_urls(const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, unsigned int threads = 0) const;
+			// Same as Lnurl::encode(create_url(params, nonce), uppercase), but the URL is encoded
+			// while it's written, so it's never stored.
+			std::string create_lnurl(const Lnurl::WithdrawParams &params, Lnurl::StringView nonce = "", bool uppercase = false) const;
+			#endif
+			// Same as the above, with the result stored in the first argument. When another status
+			// than Status::Ok is returned, the result is unspecified. create_urls returns the error
+			// of the first (by input order) params which can't be signed.
+			Lnurl::Status create_url(std::string &url, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			Lnurl::Status url_length(size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			Lnurl::Status create_url(Span<char> output, size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			// The (NUL-terminated) URL is allocated from the arena (see Lnurl::Arena).
+			Lnurl::Status create_url(Lnurl::Arena &arena, Lnurl::StringView &url, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			Lnurl::Status create_template(Lnurl::SigningTemplate &t_template, const Lnurl::WithdrawParams &params) const;
+			Lnurl::Status create_urls(std::vector<std::string> &urls, const std::vector<Lnurl::WithdrawParams> &params, const std::vector<std::string> &nonces, unsigned int threads = 0) const;
+			Lnurl::Status create_lnurl(std::string &lnurl, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce, bool uppercase = false) const;
+			// Length of the LNURL (excluding the NUL terminator) that create_lnurl will produce.
+			Lnurl::Status lnurl_length(size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce) const;
+			// Writes the NUL-terminated LNURL into output, which must have room for at least
+			// lnurl_length(params, nonce) + 1 characters.
+			Lnurl::Status create_lnurl(Span<char> output, size_t &length, const Lnurl::WithdrawParams &params, Lnurl::StringView nonce, bool uppercase = false) const;
 	};
 }
 
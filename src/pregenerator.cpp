@@ -0,0 +1,188 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pregenerator.h"
+
+#if !defined(ESP_PLATFORM) && defined(LNURL_THREADS)
+#include <chrono>
+#endif
+
+namespace Lnurl {
+
+	Pregenerator::~Pregenerator() {
+		stop();
+	}
+
+	Lnurl::Status Pregenerator::init(const Lnurl::Signer &signer, const Lnurl::WithdrawParams &params, size_t capacity, size_t maxNonceLength, NonceGenerator t_nonceGenerator, bool t_uppercase) {
+		if (running.load()) {
+			return Lnurl::Status::PregeneratorRunning;
+		}
+		// Waits for a task which stopped on an error.
+		stop();
+		Lnurl::Status status = signer.create_template(t_template, params);
+		if (status != Lnurl::Status::Ok) {
+			t_status.store(status);
+			return status;
+		}
+		// The longest URL: every character of the nonce percent-encoded.
+		size_t urlLength;
+		status = t_template.url_length(urlLength, "n");
+		if (status != Lnurl::Status::Ok) {
+			t_status.store(status);
+			return status;
+		}
+		urlLength += 3 * maxNonceLength - 1;
+		nonceGenerator = t_nonceGenerator;
+		uppercase = t_uppercase;
+		maxNonce = maxNonceLength;
+		nonce.resize(maxNonceLength);
+		slotCount = capacity + 1;
+		slotSize = bech32::EncodedBytesLength(5, urlLength) + 1;
+		slots.resize(slotCount * slotSize);
+		lengths.resize(slotCount);
+		head.store(0);
+		tail.store(0);
+		t_status.store(Lnurl::Status::Ok);
+		return Lnurl::Status::Ok;
+	}
+
+	size_t Pregenerator::fill() {
+		size_t added = 0;
+		size_t t_tail = tail.load(std::memory_order_relaxed);
+		while (t_status.load(std::memory_order_relaxed) == Lnurl::Status::Ok) {
+			const size_t next = t_tail + 1 == slotCount ? 0 : t_tail + 1;
+			if (slotCount == 0 || next == head.load(std::memory_order_acquire)) {
+				break;
+			}
+			const size_t nonceLength = nonceGenerator(Span<char>(nonce.data(), nonce.size()));
+			if (nonceLength == 0) {
+				break;
+			}
+			if (nonceLength > maxNonce) {
+				t_status.store(Lnurl::Status::NonceTooLong);
+				break;
+			}
+			// The LNURL is encoded straight into the slot.
+			size_t length;
+			const Lnurl::Status status = t_template.create_lnurl(Span<char>(&slots[t_tail * slotSize], slotSize), length, Lnurl::StringView(nonce.data(), nonceLength), uppercase);
+			if (status != Lnurl::Status::Ok) {
+				t_status.store(status);
+				break;
+			}
+			lengths[t_tail] = length;
+			// Publishes the slot to the consumer.
+			tail.store(next, std::memory_order_release);
+			t_tail = next;
+			added++;
+		}
+		return added;
+	}
+
+	Lnurl::Status Pregenerator::status() const {
+		return t_status.load();
+	}
+
+	Lnurl::StringView Pregenerator::front() const {
+		const size_t t_head = head.load(std::memory_order_relaxed);
+		if (t_head == tail.load(std::memory_order_acquire)) {
+			return Lnurl::StringView();
+		}
+		return Lnurl::StringView(&slots[t_head * slotSize], lengths[t_head]);
+	}
+
+	void Pregenerator::pop() {
+		const size_t t_head = head.load(std::memory_order_relaxed);
+		if (t_head == tail.load(std::memory_order_acquire)) {
+			return;
+		}
+		head.store(t_head + 1 == slotCount ? 0 : t_head + 1, std::memory_order_release);
+	}
+
+	size_t Pregenerator::size() const {
+		const size_t t_head = head.load(std::memory_order_acquire);
+		const size_t t_tail = tail.load(std::memory_order_acquire);
+		return t_tail >= t_head ? t_tail - t_head : t_tail + slotCount - t_head;
+	}
+
+	size_t Pregenerator::capacity() const {
+		return slotCount ? slotCount - 1 : 0;
+	}
+
+	void Pregenerator::run() {
+		while (running.load(std::memory_order_acquire)) {
+			if (fill() == 0) {
+				if (t_status.load() != Lnurl::Status::Ok) {
+					running.store(false, std::memory_order_release);
+					break;
+				}
+				#if defined(ESP_PLATFORM)
+				vTaskDelay(pdMS_TO_TICKS(interval) > 0 ? pdMS_TO_TICKS(interval) : 1);
+				#elif defined(LNURL_THREADS)
+				std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+				#endif
+			}
+		}
+	}
+
+#if defined(ESP_PLATFORM)
+	void Pregenerator::task_main(void* self) {
+		Pregenerator* pregenerator = static_cast<Pregenerator*>(self);
+		pregenerator->run();
+		pregenerator->finished.store(true, std::memory_order_release);
+		vTaskDelete(nullptr);
+	}
+#endif
+
+	bool Pregenerator::start(uint32_t t_interval, unsigned int priority) {
+		if (running.load() || slotCount == 0 || t_status.load() != Lnurl::Status::Ok) {
+			return false;
+		}
+		interval = t_interval;
+		running.store(true);
+#if defined(ESP_PLATFORM)
+		finished.store(false);
+		if (xTaskCreate(task_main, "lnurl_pregenerator", TASK_STACK_SIZE, this, priority, nullptr) != pdPASS) {
+			running.store(false);
+			finished.store(true);
+			return false;
+		}
+		return true;
+#elif defined(LNURL_THREADS)
+		// Host threads have no priority to set.
+		(void)priority;
+		worker = std::thread([this]() { run(); });
+		return true;
+#else
+		(void)priority;
+		running.store(false);
+		return false;
+#endif
+	}
+
+	void Pregenerator::stop() {
+		running.store(false, std::memory_order_release);
+#if defined(ESP_PLATFORM)
+		while (!finished.load(std::memory_order_acquire)) {
+			vTaskDelay(1);
+		}
+#elif defined(LNURL_THREADS)
+		if (worker.joinable()) {
+			worker.join();
+		}
+#endif
+	}
+}
@@ -0,0 +1,119 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LNURL_PREGENERATOR_H
+#define LNURL_PREGENERATOR_H
+
+#include "lnurl.h"
+
+#include <atomic>
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif defined(LNURL_THREADS)
+#include <thread>
+#endif
+
+namespace Lnurl {
+
+	// Keeps a number of signed (and bech32-encoded) LNURLs for the same params ready, so that
+	// showing one doesn't wait for the signing. The LNURLs are made by a producer (fill(), or
+	// the background task of start()) and taken by one consumer (front() and pop()) through a
+	// lock-free single-producer/single-consumer ring:
+	//
+	//   Lnurl::Pregenerator pregenerator;
+	//   pregenerator.init(signer, params, 4, 32, [](Span<char> nonce) { ... return length; });
+	//   pregenerator.start();
+	//   ...
+	//   const Lnurl::StringView lnurl = pregenerator.front();
+	//   if (!lnurl.empty()) {
+	//     // Show lnurl (e.g. as a QR code), then:
+	//     pregenerator.pop();
+	//   }
+	//
+	// The background task is a FreeRTOS task on the ESP32 and a std::thread on hosts (with
+	// LNURL_THREADS). Elsewhere, fill() can be called when the device is idle.
+	class Pregenerator {
+		public:
+			// Writes a nonce (which must be unique for each URL) and returns its length, or 0
+			// if no nonce can be made now (fill() then stops until it's called again).
+			// A nonce longer than nonce.size() is an error (Status::NonceTooLong).
+			typedef std::function<size_t(Span<char> nonce)> NonceGenerator;
+			// Stack of the FreeRTOS task (bytes).
+			static const uint32_t TASK_STACK_SIZE = 4096;
+			Pregenerator() {}
+			Pregenerator(const Pregenerator&) = delete;
+			Pregenerator& operator=(const Pregenerator&) = delete;
+			~Pregenerator();
+			// Prepares the signing of up to capacity LNURLs, with nonces of up to maxNonceLength
+			// characters. Returns Status::PregeneratorRunning while the background task runs.
+			Lnurl::Status init(const Lnurl::Signer &signer, const Lnurl::WithdrawParams &params, size_t capacity, size_t maxNonceLength, NonceGenerator t_nonceGenerator, bool t_uppercase = false);
+			// Producer: signs LNURLs until the ring is full (or no nonce is available).
+			// Returns the number of LNURLs added. Not to be called while the background task runs.
+			// If a nonce or the signing fails, the error is kept (see status()), and nothing
+			// is added until init() is called again.
+			size_t fill();
+			// The error of the last init() or fill(), or Status::Ok.
+			Lnurl::Status status() const;
+			// Consumer: the oldest ready LNURL (NUL-terminated), or an empty view if there is none.
+			// It stays valid until pop().
+			Lnurl::StringView front() const;
+			// Consumer: hands the slot of the LNURL returned by front() back to the producer.
+			void pop();
+			// Number of ready LNURLs.
+			size_t size() const;
+			size_t capacity() const;
+			// Refills the ring in the background, checking every interval milliseconds whether
+			// it needs to. The task stops by itself on an error (see status()). Returns false
+			// if there is no background task in this build, if there is an error, or if it
+			// couldn't be started.
+			bool start(uint32_t t_interval = 10, unsigned int priority = 1);
+			// Waits for the background task to finish.
+			void stop();
+		private:
+			Lnurl::SigningTemplate t_template;
+			NonceGenerator nonceGenerator;
+			bool uppercase = false;
+			size_t maxNonce = 0;
+			std::vector<char> nonce;
+			// capacity + 1 slots (one is always free), each of slotSize characters.
+			std::vector<char> slots;
+			std::vector<size_t> lengths;
+			size_t slotCount = 0;
+			size_t slotSize = 0;
+			// The consumer reads from head, the producer writes at tail.
+			std::atomic<size_t> head{0};
+			std::atomic<size_t> tail{0};
+			std::atomic<Lnurl::Status> t_status{Lnurl::Status::Ok};
+			std::atomic<bool> running{false};
+			uint32_t interval = 10;
+			void run();
+			#if defined(ESP_PLATFORM)
+			std::atomic<bool> finished{true};
+			static void task_main(void* self);
+			#elif defined(LNURL_THREADS)
+			std::thread worker;
+			#endif
+	};
+}
+
+#endif
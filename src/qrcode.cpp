@@ -0,0 +1,524 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "qrcode.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+	// Error correction codewords per block, and number of blocks, by error correction level
+	// (Low, Medium, Quartile, High) and version (index 0 is unused).
+	const int8_t eccCodewordsPerBlock[4][41] = {
+		{ -1,  7, 10, 15, 20, 26, 18, 20, 24, 30, 18, 20, 24, 26, 30, 22, 24, 28, 30, 28, 28, 28, 28, 30, 30, 26, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30 },
+		{ -1, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26, 30, 22, 22, 24, 24, 28, 28, 26, 26, 26, 26, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28 },
+		{ -1, 13, 22, 18, 26, 18, 24, 18, 22, 20, 24, 28, 26, 24, 20, 30, 24, 28, 28, 26, 30, 28, 30, 30, 30, 30, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30 },
+		{ -1, 17, 28, 22, 16, 22, 28, 26, 26, 24, 28, 24, 28, 22, 24, 24, 30, 28, 28, 26, 28, 30, 24, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30 },
+	};
+	const int8_t eccBlocks[4][41] = {
+		{ -1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4, 4, 4, 4, 4, 6, 6, 6, 6, 7, 8, 8, 9, 9, 10, 12, 12, 12, 13, 14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 24, 25 },
+		{ -1, 1, 1, 1, 2, 2, 4, 4, 4, 5, 5, 5, 8, 9, 9, 10, 10, 11, 13, 14, 16, 17, 17, 18, 20, 21, 23, 25, 26, 28, 29, 31, 33, 35, 37, 38, 40, 43, 45, 47, 49 },
+		{ -1, 1, 1, 2, 2, 4, 4, 6, 6, 8, 8, 8, 10, 12, 16, 12, 17, 16, 18, 21, 20, 23, 23, 25, 27, 29, 34, 34, 35, 38, 40, 43, 45, 48, 51, 53, 56, 59, 62, 65, 68 },
+		{ -1, 1, 1, 2, 4, 4, 4, 5, 6, 8, 8, 11, 11, 16, 16, 18, 16, 19, 21, 25, 25, 25, 34, 30, 32, 35, 37, 40, 42, 45, 48, 51, 54, 57, 60, 63, 66, 70, 74, 77, 81 },
+	};
+	const int maxEccCodewordsPerBlock = 30;
+
+	// The 2-bit level indicator of each error correction level in the format information.
+	const int eccFormatBits[4] = { 1, 0, 3, 2 };
+
+	// Value of each alphanumeric character, or -1.
+	int alphanumeric_value(char c) {
+		if (c >= '0' && c <= '9') {
+			return c - '0';
+		}
+		if (c >= 'A' && c <= 'Z') {
+			return c - 'A' + 10;
+		}
+		switch (c) {
+			case ' ': return 36;
+			case '$': return 37;
+			case '%': return 38;
+			case '*': return 39;
+			case '+': return 40;
+			case '-': return 41;
+			case '.': return 42;
+			case '/': return 43;
+			case ':': return 44;
+		}
+		return -1;
+	}
+
+	int character_count_bits(int version) {
+		return version <= 9 ? 9 : (version <= 26 ? 11 : 13);
+	}
+
+	size_t data_codewords(int version, Lnurl::QrCode::Ecc ecc) {
+		const int level = static_cast<int>(ecc);
+		return Lnurl::QrCode::codewords(version) - eccCodewordsPerBlock[level][version] * eccBlocks[level][version];
+	}
+
+	// Appends bits to a zeroed buffer, most significant bit first.
+	class BitWriter {
+		public:
+			explicit BitWriter(uint8_t *t_data) : data(t_data) {}
+			void write(uint32_t value, int count) {
+				for (int i = count - 1; i >= 0; i--, position++) {
+					data[position >> 3] |= ((value >> i) & 1) << (7 - (position & 7));
+				}
+			}
+			size_t position = 0;
+		private:
+			uint8_t *data;
+	};
+
+	// Multiplication in GF(2^8) modulo x^8 + x^4 + x^3 + x^2 + 1.
+	uint8_t gf_multiply(uint8_t x, uint8_t y) {
+		int z = 0;
+		for (int i = 7; i >= 0; i--) {
+			z = (z << 1) ^ ((z >> 7) * 0x11D);
+			z ^= ((y >> i) & 1) * x;
+		}
+		return static_cast<uint8_t>(z);
+	}
+
+	// Coefficients (highest degree first, leading 1 omitted) of the Reed-Solomon generator
+	// polynomial (x - r^0)(x - r^1)...(x - r^(degree-1)), where r = 0x02.
+	void reed_solomon_divisor(uint8_t *divisor, int degree) {
+		memset(divisor, 0, degree);
+		divisor[degree - 1] = 1;
+		uint8_t root = 1;
+		for (int i = 0; i < degree; i++) {
+			for (int j = 0; j < degree; j++) {
+				divisor[j] = gf_multiply(divisor[j], root);
+				if (j + 1 < degree) {
+					divisor[j] ^= divisor[j + 1];
+				}
+			}
+			root = gf_multiply(root, 0x02);
+		}
+	}
+
+	void reed_solomon_remainder(const uint8_t *data, size_t length, const uint8_t *divisor, int degree, uint8_t *remainder) {
+		memset(remainder, 0, degree);
+		for (size_t i = 0; i < length; i++) {
+			const uint8_t factor = data[i] ^ remainder[0];
+			memmove(remainder, remainder + 1, degree - 1);
+			remainder[degree - 1] = 0;
+			for (int j = 0; j < degree; j++) {
+				remainder[j] ^= gf_multiply(divisor[j], factor);
+			}
+		}
+	}
+
+	// Penalty of the finder-like pattern (dark:light 1:1:3:1:1, with 4 light on one side)
+	// ending at the latest run. history[0] is the latest run, starting with a light one.
+	int finder_penalty_count(const int *history) {
+		const int n = history[1];
+		const bool core = n > 0 && history[2] == n && history[3] == n * 3 && history[4] == n && history[5] == n;
+		return (core && history[0] >= n * 4 && history[6] >= n ? 1 : 0)
+			+ (core && history[6] >= n * 4 && history[0] >= n ? 1 : 0);
+	}
+
+	void finder_penalty_add_history(int runLength, int *history, int size) {
+		if (history[0] == 0) {
+			// The light border before the first run.
+			runLength += size;
+		}
+		memmove(history + 1, history, 6 * sizeof(int));
+		history[0] = runLength;
+	}
+
+	// Penalty rules of ISO/IEC 18004 section 7.8.3.
+	const int penaltyN1 = 3;
+	const int penaltyN2 = 3;
+	const int penaltyN3 = 40;
+	const int penaltyN4 = 10;
+}
+
+namespace Lnurl {
+
+	int QrCode::min_version(size_t length, Ecc ecc) {
+		for (int t_version = MIN_VERSION; t_version <= MAX_VERSION; t_version++) {
+			const size_t bits = 4 + character_count_bits(t_version) + 11 * (length / 2) + 6 * (length % 2);
+			if (length < (size_t(1) << character_count_bits(t_version)) && bits <= data_codewords(t_version, ecc) * 8) {
+				return t_version;
+			}
+		}
+		return 0;
+	}
+
+	bool QrCode::is_alphanumeric(char c) {
+		return alphanumeric_value(c) >= 0;
+	}
+
+	QrCode::QrCode() : modules(nullptr), version(0), size(0), mask(0), ecc(Ecc::Medium) {}
+
+	#ifndef LNURL_NO_EXCEPTIONS
+	QrCode::QrCode(Span<const char> text, Span<uint8_t> buffer, Ecc t_ecc, int t_mask) : QrCode() {
+		const Lnurl::Status status = encode(text, buffer, t_ecc, t_mask);
+		if (status != Lnurl::Status::Ok) {
+			throw std::invalid_argument(Lnurl::status_message(status));
+		}
+	}
+	#endif
+
+	Lnurl::Status QrCode::encode(Span<const char> text, Span<uint8_t> buffer, Ecc t_ecc, int t_mask) {
+		for (const char c : text) {
+			if (!is_alphanumeric(c)) {
+				return Lnurl::Status::QrCodeTextNotAlphanumeric;
+			}
+		}
+		if (t_mask < -1 || t_mask > 7) {
+			return Lnurl::Status::QrCodeInvalidMask;
+		}
+		const int t_version = min_version(text.size(), t_ecc);
+		if (t_version == 0) {
+			return Lnurl::Status::QrCodeTextTooLong;
+		}
+		if (buffer.size() < buffer_size(t_version)) {
+			return Lnurl::Status::QrCodeBufferTooSmall;
+		}
+		ecc = t_ecc;
+		version = t_version;
+		size = 4 * version + 17;
+		modules = buffer.data();
+		const size_t moduleBytes = (size * size + 7) / 8;
+		uint8_t *codewords = buffer.data() + moduleBytes;
+		const size_t totalCodewords = QrCode::codewords(version);
+		const size_t dataCodewords = data_codewords(version, ecc);
+
+		// The data codewords are put together in the (larger) module area first.
+		uint8_t *data = modules;
+		memset(data, 0, moduleBytes);
+		BitWriter bits(data);
+		bits.write(0x2, 4);
+		bits.write(text.size(), character_count_bits(version));
+		size_t i = 0;
+		for (; i + 1 < text.size(); i += 2) {
+			bits.write(alphanumeric_value(text[i]) * 45 + alphanumeric_value(text[i + 1]), 11);
+		}
+		if (i < text.size()) {
+			bits.write(alphanumeric_value(text[i]), 6);
+		}
+		// Terminator (up to 4 zero bits), zeros up to a byte boundary, then alternating pad bytes.
+		const size_t capacity = dataCodewords * 8;
+		bits.position += capacity - bits.position < 4 ? capacity - bits.position : 4;
+		bits.position = (bits.position + 7) / 8 * 8;
+		for (uint8_t pad = 0xEC; bits.position < capacity; pad ^= 0xEC ^ 0x11) {
+			bits.write(pad, 8);
+		}
+
+		// Split the data into blocks, add the error correction codewords to each block,
+		// and interleave the blocks.
+		const int level = static_cast<int>(ecc);
+		const size_t blockCount = eccBlocks[level][version];
+		const int eccLength = eccCodewordsPerBlock[level][version];
+		const size_t shortBlockCount = blockCount - totalCodewords % blockCount;
+		const size_t shortDataLength = totalCodewords / blockCount - eccLength;
+		uint8_t divisor[maxEccCodewordsPerBlock];
+		uint8_t remainder[maxEccCodewordsPerBlock];
+		reed_solomon_divisor(divisor, eccLength);
+		const uint8_t *block = data;
+		for (size_t b = 0; b < blockCount; b++) {
+			const size_t dataLength = shortDataLength + (b < shortBlockCount ? 0 : 1);
+			reed_solomon_remainder(block, dataLength, divisor, eccLength, remainder);
+			for (size_t j = 0; j < dataLength; j++) {
+				// Long blocks have one more data codeword, which goes after those of all blocks.
+				const size_t k = j < shortDataLength ? j * blockCount + b : shortDataLength * blockCount + b - shortBlockCount;
+				codewords[k] = block[j];
+			}
+			for (int j = 0; j < eccLength; j++) {
+				codewords[dataCodewords + j * blockCount + b] = remainder[j];
+			}
+			block += dataLength;
+		}
+
+		memset(modules, 0, moduleBytes);
+		alignmentCount = 0;
+		if (version >= 2) {
+			// Alignment patterns are evenly spaced from size - 7 down to the second one,
+			// and the first one is always at 6.
+			const int count = version / 7 + 2;
+			const int step = (version * 8 + count * 3 + 5) / (count * 4 - 4) * 2;
+			alignmentPositions[0] = 6;
+			for (int k = count - 1, position = size - 7; k >= 1; k--, position -= step) {
+				alignmentPositions[k] = position;
+			}
+			alignmentCount = count;
+		}
+		draw_function_patterns();
+		draw_codewords(codewords, totalCodewords);
+
+		if (t_mask == -1) {
+			long minPenalty = 0;
+			for (int m = 0; m < 8; m++) {
+				apply_mask(m);
+				draw_format_bits(m);
+				const long penalty = penalty_score();
+				if (t_mask == -1 || penalty < minPenalty) {
+					t_mask = m;
+					minPenalty = penalty;
+				}
+				// Masking is its own inverse.
+				apply_mask(m);
+			}
+		}
+		mask = t_mask;
+		apply_mask(mask);
+		draw_format_bits(mask);
+		return Lnurl::Status::Ok;
+	}
+
+	int QrCode::get_version() const {
+		return version;
+	}
+
+	int QrCode::get_mask() const {
+		return mask;
+	}
+
+	QrCode::Ecc QrCode::get_ecc() const {
+		return ecc;
+	}
+
+	int QrCode::get_size() const {
+		return size;
+	}
+
+	bool QrCode::get_module(int x, int y) const {
+		const size_t i = y * size + x;
+		return (modules[i >> 3] >> (i & 7)) & 1;
+	}
+
+	void QrCode::set_module(int x, int y, bool dark) {
+		const size_t i = y * size + x;
+		if (dark) {
+			modules[i >> 3] |= 1 << (i & 7);
+		} else {
+			modules[i >> 3] &= ~(1 << (i & 7));
+		}
+	}
+
+	bool QrCode::is_function_module(int x, int y) const {
+		// Finder patterns with their separators, and the format information next to them
+		// (including the dark module above the bottom left finder).
+		if ((x <= 8 && y <= 8) || (x >= size - 8 && y <= 8) || (x <= 8 && y >= size - 8)) {
+			return true;
+		}
+		// Timing patterns.
+		if (x == 6 || y == 6) {
+			return true;
+		}
+		// Version information.
+		if (version >= 7 && ((x >= size - 11 && x < size - 8 && y < 6) || (y >= size - 11 && y < size - 8 && x < 6))) {
+			return true;
+		}
+		// Alignment patterns (none overlaps the finders, nor do they overlap each other).
+		int alignX = -1, alignY = -1;
+		for (int i = 0; i < alignmentCount; i++) {
+			if (std::abs(x - alignmentPositions[i]) <= 2) {
+				alignX = i;
+			}
+			if (std::abs(y - alignmentPositions[i]) <= 2) {
+				alignY = i;
+			}
+		}
+		if (alignX == -1 || alignY == -1) {
+			return false;
+		}
+		const int last = alignmentCount - 1;
+		return !((alignX == 0 && alignY == 0) || (alignX == 0 && alignY == last) || (alignX == last && alignY == 0));
+	}
+
+	void QrCode::draw_function_patterns() {
+		for (int i = 0; i < size; i++) {
+			set_module(6, i, i % 2 == 0);
+			set_module(i, 6, i % 2 == 0);
+		}
+		const int finders[3][2] = { { 3, 3 }, { size - 4, 3 }, { 3, size - 4 } };
+		for (const auto &finder : finders) {
+			for (int dy = -4; dy <= 4; dy++) {
+				for (int dx = -4; dx <= 4; dx++) {
+					const int x = finder[0] + dx, y = finder[1] + dy;
+					const int distance = std::max(std::abs(dx), std::abs(dy));
+					if (x >= 0 && x < size && y >= 0 && y < size) {
+						set_module(x, y, distance != 2 && distance != 4);
+					}
+				}
+			}
+		}
+		const int last = alignmentCount - 1;
+		for (int i = 0; i < alignmentCount; i++) {
+			for (int j = 0; j < alignmentCount; j++) {
+				if ((i == 0 && j == 0) || (i == 0 && j == last) || (i == last && j == 0)) {
+					continue;
+				}
+				for (int dy = -2; dy <= 2; dy++) {
+					for (int dx = -2; dx <= 2; dx++) {
+						set_module(alignmentPositions[i] + dx, alignmentPositions[j] + dy, std::max(std::abs(dx), std::abs(dy)) != 1);
+					}
+				}
+			}
+		}
+		if (version >= 7) {
+			// 6-bit version number and its (18, 6) Golay code.
+			uint32_t remainder = version;
+			for (int i = 0; i < 12; i++) {
+				remainder = (remainder << 1) ^ ((remainder >> 11) * 0x1F25);
+			}
+			const uint32_t versionBits = static_cast<uint32_t>(version) << 12 | remainder;
+			for (int i = 0; i < 18; i++) {
+				const bool dark = (versionBits >> i) & 1;
+				const int a = size - 11 + i % 3, b = i / 3;
+				set_module(a, b, dark);
+				set_module(b, a, dark);
+			}
+		}
+		// The dark module.
+		set_module(8, size - 8, true);
+	}
+
+	void QrCode::draw_format_bits(int t_mask) {
+		// Error correction level and mask, with their (15, 5) BCH code.
+		const uint32_t data = eccFormatBits[static_cast<int>(ecc)] << 3 | t_mask;
+		uint32_t remainder = data;
+		for (int i = 0; i < 10; i++) {
+			remainder = (remainder << 1) ^ ((remainder >> 9) * 0x537);
+		}
+		const uint32_t formatBits = (data << 10 | remainder) ^ 0x5412;
+		// First copy, around the top left finder.
+		for (int i = 0; i <= 5; i++) {
+			set_module(8, i, (formatBits >> i) & 1);
+		}
+		set_module(8, 7, (formatBits >> 6) & 1);
+		set_module(8, 8, (formatBits >> 7) & 1);
+		set_module(7, 8, (formatBits >> 8) & 1);
+		for (int i = 9; i < 15; i++) {
+			set_module(14 - i, 8, (formatBits >> i) & 1);
+		}
+		// Second copy, split between the top right and bottom left finders.
+		for (int i = 0; i < 8; i++) {
+			set_module(size - 1 - i, 8, (formatBits >> i) & 1);
+		}
+		for (int i = 8; i < 15; i++) {
+			set_module(8, size - 15 + i, (formatBits >> i) & 1);
+		}
+	}
+
+	void QrCode::draw_codewords(const uint8_t *codewords, size_t count) {
+		// Two columns at a time, from the right, alternately upwards and downwards, skipping
+		// the vertical timing pattern. The remainder bits (if any) are left light.
+		size_t i = 0;
+		for (int right = size - 1; right >= 1; right -= 2) {
+			if (right == 6) {
+				right = 5;
+			}
+			const bool upward = ((right + 1) & 2) == 0;
+			for (int vertical = 0; vertical < size; vertical++) {
+				const int y = upward ? size - 1 - vertical : vertical;
+				for (int j = 0; j < 2; j++) {
+					const int x = right - j;
+					if (!is_function_module(x, y) && i < count * 8) {
+						set_module(x, y, (codewords[i >> 3] >> (7 - (i & 7))) & 1);
+						i++;
+					}
+				}
+			}
+		}
+	}
+
+	void QrCode::apply_mask(int t_mask) {
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				bool invert;
+				switch (t_mask) {
+					case 0: invert = (x + y) % 2 == 0; break;
+					case 1: invert = y % 2 == 0; break;
+					case 2: invert = x % 3 == 0; break;
+					case 3: invert = (x + y) % 3 == 0; break;
+					case 4: invert = (x / 3 + y / 2) % 2 == 0; break;
+					case 5: invert = x * y % 2 + x * y % 3 == 0; break;
+					case 6: invert = (x * y % 2 + x * y % 3) % 2 == 0; break;
+					default: invert = ((x + y) % 2 + x * y % 3) % 2 == 0; break;
+				}
+				if (invert && !is_function_module(x, y)) {
+					set_module(x, y, !get_module(x, y));
+				}
+			}
+		}
+	}
+
+	long QrCode::penalty_score() const {
+		long result = 0;
+		// Runs of five or more modules of the same color, and finder-like patterns, in rows
+		// (pass 0) and columns (pass 1).
+		for (int pass = 0; pass < 2; pass++) {
+			for (int a = 0; a < size; a++) {
+				bool runColor = false;
+				int runLength = 0;
+				int history[7] = {};
+				for (int b = 0; b < size; b++) {
+					const bool color = pass == 0 ? get_module(b, a) : get_module(a, b);
+					if (color == runColor) {
+						runLength++;
+						if (runLength == 5) {
+							result += penaltyN1;
+						} else if (runLength > 5) {
+							result++;
+						}
+					} else {
+						finder_penalty_add_history(runLength, history, size);
+						if (!runColor) {
+							result += finder_penalty_count(history) * penaltyN3;
+						}
+						runColor = color;
+						runLength = 1;
+					}
+				}
+				// The light border after the last run.
+				if (runColor) {
+					finder_penalty_add_history(runLength, history, size);
+					runLength = 0;
+				}
+				finder_penalty_add_history(runLength + size, history, size);
+				result += finder_penalty_count(history) * penaltyN3;
+			}
+		}
+		// 2x2 blocks of the same color.
+		for (int y = 0; y < size - 1; y++) {
+			for (int x = 0; x < size - 1; x++) {
+				const bool color = get_module(x, y);
+				if (color == get_module(x + 1, y) && color == get_module(x, y + 1) && color == get_module(x + 1, y + 1)) {
+					result += penaltyN2;
+				}
+			}
+		}
+		// Balance of dark and light modules, in steps of 5% away from 50%.
+		long dark = 0;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				dark += get_module(x, y) ? 1 : 0;
+			}
+		}
+		const long total = static_cast<long>(size) * size;
+		const long k = (std::labs(dark * 20 - total * 10) + total - 1) / total - 1;
+		return result + k * penaltyN4;
+	}
+}
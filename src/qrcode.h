@@ -0,0 +1,95 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LNURL_QRCODE_H
+#define LNURL_QRCODE_H
+
+#include "span.h"
+#include "status.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Lnurl {
+
+	// QR code (ISO/IEC 18004, model 2) of a text in alphanumeric mode. Uppercase LNURLs
+	// (see Lnurl::encode) only contain alphanumeric characters, which take 5.5 bits each
+	// instead of 8 in byte mode. The modules are drawn into a caller buffer, so encoding
+	// doesn't allocate:
+	//
+	//   uint8_t buffer[Lnurl::QrCode::buffer_size(10)];
+	//   Lnurl::QrCode qr(Lnurl::encode(url, true), buffer);
+	class QrCode {
+		public:
+			// Error correction level: about 7%, 15%, 25% or 30% of the codewords can be restored.
+			enum class Ecc : uint8_t { Low, Medium, Quartile, High };
+			static const int MIN_VERSION = 1;
+			static const int MAX_VERSION = 40;
+			// Codewords (data and error correction) of a code of the given version.
+			static constexpr size_t codewords(int version) {
+				return (((16 * version + 128) * version + 64)
+					- (version >= 2 ? (25 * (version / 7 + 2) - 10) * (version / 7 + 2) - 55 : 0)
+					- (version >= 7 ? 36 : 0)) / 8;
+			}
+			// Bytes of buffer needed for a code of the given version: the modules (one bit each)
+			// followed by the codewords.
+			static constexpr size_t buffer_size(int version) {
+				return ((4 * version + 17) * (4 * version + 17) + 7) / 8 + codewords(version);
+			}
+			// Smallest version which holds length alphanumeric characters, or 0 if none does.
+			static int min_version(size_t length, Ecc ecc);
+			// Digits, uppercase letters, space and $%*+-./:
+			static bool is_alphanumeric(char c);
+			// Empty code (version 0), until encode succeeds.
+			QrCode();
+			#ifndef LNURL_NO_EXCEPTIONS
+			// Same as encode, but throws std::invalid_argument instead of returning an error.
+			QrCode(Span<const char> text, Span<uint8_t> buffer, Ecc ecc = Ecc::Medium, int mask = -1);
+			#endif
+			// Encodes text with the smallest version that holds it. The buffer must have room
+			// for buffer_size(get_version()) bytes, and is used until the code is destroyed.
+			// The mask (0-7) is chosen by penalty score unless one is given.
+			// Returns an error (and leaves the code as it was) if the text isn't alphanumeric,
+			// or doesn't fit in a version 40 code or in the buffer.
+			Lnurl::Status encode(Span<const char> text, Span<uint8_t> buffer, Ecc ecc = Ecc::Medium, int mask = -1);
+			int get_version() const;
+			int get_mask() const;
+			Ecc get_ecc() const;
+			// Width (and height) in modules, without the quiet zone: 4 * version + 17.
+			int get_size() const;
+			// True for dark modules. (0, 0) is the top left module.
+			bool get_module(int x, int y) const;
+		private:
+			uint8_t* modules;
+			int version;
+			int size;
+			int mask;
+			Ecc ecc;
+			// Centers of the alignment patterns, on either axis.
+			uint8_t alignmentPositions[7];
+			uint8_t alignmentCount = 0;
+			void set_module(int x, int y, bool dark);
+			bool is_function_module(int x, int y) const;
+			void draw_function_patterns();
+			void draw_format_bits(int t_mask);
+			void draw_codewords(const uint8_t *codewords, size_t count);
+			void apply_mask(int t_mask);
+			long penalty_score() const;
+	};
+}
+
+#endif
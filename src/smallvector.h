@@ -0,0 +1,120 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LNURL_SMALLVECTOR_H
+#define LNURL_SMALLVECTOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace Lnurl {
+
+	// Vector of trivially copyable elements which keeps up to N of them inline,
+	// and only moves to the heap when it grows beyond that.
+	template<typename T, size_t N>
+	class SmallVector {
+		static_assert(std::is_trivially_copyable<T>::value, "SmallVector elements must be trivially copyable");
+		public:
+			SmallVector() {}
+			SmallVector(const SmallVector &other) {
+				append(other.data(), other.size());
+			}
+			SmallVector(SmallVector &&other) {
+				*this = std::move(other);
+			}
+			SmallVector& operator=(const SmallVector &other) {
+				if (this != &other) {
+					count = 0;
+					append(other.data(), other.size());
+				}
+				return *this;
+			}
+			SmallVector& operator=(SmallVector &&other) {
+				if (this == &other) {
+					return *this;
+				}
+				if (other.heap) {
+					// Take over the heap buffer.
+					delete[] heap;
+					heap = other.heap;
+					count = other.count;
+					capacity = other.capacity;
+					other.heap = nullptr;
+					other.count = 0;
+					other.capacity = N;
+				} else {
+					count = 0;
+					append(other.data(), other.size());
+				}
+				return *this;
+			}
+			~SmallVector() {
+				delete[] heap;
+			}
+			T* data() { return heap ? heap : local; }
+			const T* data() const { return heap ? heap : local; }
+			T* begin() { return data(); }
+			const T* begin() const { return data(); }
+			T* end() { return data() + count; }
+			const T* end() const { return data() + count; }
+			T& operator[](size_t i) { return data()[i]; }
+			const T& operator[](size_t i) const { return data()[i]; }
+			size_t size() const { return count; }
+			bool empty() const { return count == 0; }
+			void clear() { count = 0; }
+			void reserve(size_t n) {
+				if (n <= capacity) {
+					return;
+				}
+				T* grown = new T[n];
+				memcpy(grown, data(), count * sizeof(T));
+				delete[] heap;
+				heap = grown;
+				capacity = n;
+			}
+			void append(const T* values, size_t n) {
+				grow_for(n);
+				memcpy(data() + count, values, n * sizeof(T));
+				count += n;
+			}
+			void push_back(const T &value) {
+				append(&value, 1);
+			}
+			// Inserts value before position i (0 <= i <= size()).
+			void insert(size_t i, const T &value) {
+				grow_for(1);
+				T* values = data();
+				memmove(values + i + 1, values + i, (count - i) * sizeof(T));
+				values[i] = value;
+				++count;
+			}
+		private:
+			T local[N];
+			T* heap = nullptr;
+			size_t count = 0;
+			size_t capacity = N;
+			void grow_for(size_t n) {
+				if (count + n > capacity) {
+					reserve(count + n > 2 * capacity ? count + n : 2 * capacity);
+				}
+			}
+	};
+}
+
+#endif
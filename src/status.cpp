@@ -0,0 +1,49 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "status.h"
+
+namespace Lnurl {
+
+	const char* status_message(Lnurl::Status status) {
+		switch (status) {
+			case Lnurl::Status::Ok: return "OK";
+			case Lnurl::Status::UnsupportedKeyEncoding: return "Invalid config (\"apiKey.encoding\"): Unsupported encoding - \"hex\", \"base64\", or \"\" are permitted.";
+			case Lnurl::Status::NotConfigured: return "Signer is not configured";
+			case Lnurl::Status::TemplateNotPrepared: return "Signing template was not prepared by Signer::create_template";
+			case Lnurl::Status::MissingNonce: return "Missing required argument: \"nonce\"";
+			case Lnurl::Status::MissingMinWithdrawable: return "Missing required parameter: \"minWithdrawable\"";
+			case Lnurl::Status::MissingMaxWithdrawable: return "Missing required parameter: \"maxWithdrawable\"";
+			case Lnurl::Status::InvalidMinWithdrawable: return "\"minWithdrawable\" must be a number";
+			case Lnurl::Status::InvalidMaxWithdrawable: return "\"maxWithdrawable\" must be a number";
+			case Lnurl::Status::NegativeMinWithdrawable: return "\"minWithdrawable\" must be greater than zero";
+			case Lnurl::Status::MaxWithdrawableBelowMin: return "\"maxWithdrawable\" must be greater than or equal to \"minWithdrawable\"";
+			case Lnurl::Status::ReservedCustomParamKey: return "Invalid custom parameter key: Reserved";
+			case Lnurl::Status::NonceCountMismatch: return "Number of nonces must equal the number of params";
+			case Lnurl::Status::UrlBufferTooSmall: return "Output buffer is too small for the signed URL";
+			case Lnurl::Status::ChunkBufferTooSmall: return "Output buffer is too small for the decoded chunk";
+			case Lnurl::Status::QrCodeBufferTooSmall: return "Buffer is too small for the QR code";
+			case Lnurl::Status::ArenaExhausted: return "Arena is too small";
+			case Lnurl::Status::QrCodeTextNotAlphanumeric: return "QR code text must be alphanumeric (0-9, A-Z, space and $%*+-./:)";
+			case Lnurl::Status::QrCodeInvalidMask: return "Invalid QR code mask";
+			case Lnurl::Status::QrCodeTextTooLong: return "Text is too long for a QR code";
+			case Lnurl::Status::NonceTooLong: return "Generated nonce is longer than the maximum nonce length";
+			case Lnurl::Status::PregeneratorRunning: return "Pregenerator is running";
+		}
+		return "Unknown error";
+	}
+}
@@ -0,0 +1,67 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LNURL_STATUS_H
+#define LNURL_STATUS_H
+
+#include <stdint.h>
+
+// Errors are thrown as std::invalid_argument, unless LNURL_NO_EXCEPTIONS is defined or the
+// library is compiled without exceptions (-fno-exceptions). Then only the entry points which
+// return a Lnurl::Status are available.
+#if !defined(LNURL_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS)
+#define LNURL_NO_EXCEPTIONS
+#endif
+
+namespace Lnurl {
+
+	enum class Status : uint8_t {
+		Ok,
+		// Signer config.
+		UnsupportedKeyEncoding,
+		NotConfigured,
+		TemplateNotPrepared,
+		// Signer params.
+		MissingNonce,
+		MissingMinWithdrawable,
+		MissingMaxWithdrawable,
+		InvalidMinWithdrawable,
+		InvalidMaxWithdrawable,
+		NegativeMinWithdrawable,
+		MaxWithdrawableBelowMin,
+		ReservedCustomParamKey,
+		NonceCountMismatch,
+		// Output buffers.
+		UrlBufferTooSmall,
+		ChunkBufferTooSmall,
+		QrCodeBufferTooSmall,
+		ArenaExhausted,
+		// QR codes.
+		QrCodeTextNotAlphanumeric,
+		QrCodeInvalidMask,
+		QrCodeTextTooLong,
+		// Pregenerator.
+		NonceTooLong,
+		PregeneratorRunning,
+	};
+
+	// The message of the std::invalid_argument which is thrown for the status (except that
+	// it doesn't name the reserved key of a Status::ReservedCustomParamKey).
+	const char* status_message(Lnurl::Status status);
+}
+
+#endif
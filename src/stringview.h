@@ -0,0 +1,49 @@
+//  lnurl-platformio - https://github.com/chill117/lnurl-platformio
+//
+//  Copyright (C) 2020 Charles Hill
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LNURL_STRINGVIEW_H
+#define LNURL_STRINGVIEW_H
+
+#include "span.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace Lnurl {
+
+	// Read-only view of characters (like C++17's std::string_view), which the public API takes
+	// instead of a std::string, so that text in static buffers, flash or received packets isn't
+	// copied first. It's a Span<const char>, so it's passed on as is to the bech32, hex and HMAC
+	// helpers. Converts from anything with c_str() and length() (std::string, Arduino's String)
+	// and from NUL-terminated C strings. Other character buffers (which may not be NUL-terminated)
+	// are passed as a Span, or with their length.
+	class StringView : public Span<const char> {
+		public:
+			constexpr StringView() noexcept {}
+			constexpr StringView(const char* t_data, size_t t_size) noexcept : Span<const char>(t_data, t_size) {}
+			constexpr StringView(Span<const char> text) noexcept : Span<const char>(text) {}
+			StringView(const char* text) noexcept : Span<const char>(text, text != nullptr ? strlen(text) : 0) {}
+			template<typename S, typename = decltype(std::declval<const S&>().c_str() + std::declval<const S&>().length())>
+			StringView(const S &text) noexcept : Span<const char>(text.c_str(), text.length()) {}
+			std::string to_string() const {
+				return std::string(data(), size());
+			}
+	};
+}
+
+#endif
@@ -1,4 +1,4 @@
-// Copied from:
+// Copied from (with the addition of HexEncode, HexDecode, ConvertBits8To5 and ConvertBits5To8, and without the stream-based ParseDouble):
 // https://github.com/bitcoin/bitcoin/blob/master/src/util/strencodings.cpp
 
 // Copyright (c) 2009-2010 Satoshi Nakamoto
@@ -9,14 +9,19 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 
-#include <tinyformat.h>
-
 #include <algorithm>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <errno.h>
 #include <limits>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 static const std::string CHARS_ALPHA_NUM = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
 
 static const std::string SAFE_CHARS[] =
@@ -88,6 +93,15 @@ std::vector<unsigned char> ParseHex(const char* psz)
 {
     // convert hex dump to vector
     std::vector<unsigned char> vch;
+    // Blocks of hex digits (without whitespace) are decoded at once, and the rest one character
+    // at a time.
+    const size_t len = strlen(psz);
+    vch.reserve(len / 2);
+    unsigned char block[16];
+    for (size_t left = len; left >= 32 && HexDecode(Span<const char>(psz, 32), block); left -= 32) {
+        vch.insert(vch.end(), block, block + 16);
+        psz += 32;
+    }
     while (true)
     {
         while (IsSpace(*psz))
@@ -283,6 +297,49 @@ std::string DecodeBase32(const std::string& str, bool* pf_invalid)
     return std::string((const char*)vchRet.data(), vchRet.size());
 }
 
+size_t ConvertBits8To5(Span<const uint8_t> in, Span<uint8_t> out)
+{
+    const size_t len = (in.size() * 8 + 4) / 5;
+    assert(out.size() >= len);
+    uint8_t* it = out.data();
+    size_t i = 0;
+    for (; i + 5 <= in.size(); i += 5) {
+        const uint64_t word = (uint64_t)in[i] << 32 | (uint32_t)in[i + 1] << 24 |
+            (uint32_t)in[i + 2] << 16 | (uint32_t)in[i + 3] << 8 | in[i + 4];
+        for (int j = 0; j < 8; ++j) it[j] = (word >> (35 - 5 * j)) & 31;
+        it += 8;
+    }
+    if (i < in.size()) {
+        // The remaining 1-4 bytes, with the last value padded with zero bits.
+        uint64_t word = 0;
+        for (size_t j = 0; j < 5; ++j) word = word << 8 | (i + j < in.size() ? in[i + j] : 0);
+        const size_t values = ((in.size() - i) * 8 + 4) / 5;
+        for (size_t j = 0; j < values; ++j) *it++ = (word >> (35 - 5 * j)) & 31;
+    }
+    return len;
+}
+
+bool ConvertBits5To8(Span<const uint8_t> in, Span<uint8_t> out)
+{
+    assert(out.size() >= in.size() * 5 / 8);
+    uint8_t* it = out.data();
+    size_t i = 0;
+    for (; i + 8 <= in.size(); i += 8) {
+        uint64_t word = 0;
+        for (int j = 0; j < 8; ++j) word = word << 5 | in[i + j];
+        for (int j = 0; j < 5; ++j) it[j] = word >> (32 - 8 * j);
+        it += 5;
+    }
+    // The remaining 0-7 values hold as many whole bytes as they can, and the rest is padding:
+    // less than a value, all zeros.
+    uint64_t word = 0;
+    const size_t bits = (in.size() - i) * 5;
+    for (; i < in.size(); ++i) word = word << 5 | in[i];
+    for (size_t j = 8; j <= bits; j += 8) *it++ = word >> (bits - j);
+    const size_t padding = bits % 8;
+    return padding < 5 && (word & ((1 << padding) - 1)) == 0;
+}
+
 NODISCARD static bool ParsePrechecks(const std::string& str)
 {
     if (str.empty()) // No empty string allowed
@@ -371,23 +428,9 @@ bool ParseUInt64(const std::string& str, uint64_t *out)
 }
 
 
-bool ParseDouble(const std::string& str, double *out)
-{
-    if (!ParsePrechecks(str))
-        return false;
-    if (str.size() >= 2 && str[0] == '0' && str[1] == 'x') // No hexadecimal floats allowed
-        return false;
-    std::istringstream text(str);
-    text.imbue(std::locale::classic());
-    double result;
-    text >> result;
-    if(out) *out = result;
-    return text.eof() && !text.fail();
-}
-
 std::string FormatParagraph(const std::string& in, size_t width, size_t indent)
 {
-    std::stringstream out;
+    std::string out;
     size_t ptr = 0;
     size_t indented = 0;
     while (ptr < in.size())
@@ -399,7 +442,7 @@ std::string FormatParagraph(const std::string& in, size_t width, size_t indent)
         const size_t linelen = lineend - ptr;
         const size_t rem_width = width - indented;
         if (linelen <= rem_width) {
-            out << in.substr(ptr, linelen + 1);
+            out.append(in, ptr, linelen + 1);
             ptr = lineend + 1;
             indented = 0;
         } else {
@@ -409,21 +452,22 @@ std::string FormatParagraph(const std::string& in, size_t width, size_t indent)
                 finalspace = in.find_first_of("\n ", ptr);
                 if (finalspace == std::string::npos) {
                     // End of the string, just add it and break
-                    out << in.substr(ptr);
+                    out.append(in, ptr, std::string::npos);
                     break;
                 }
             }
-            out << in.substr(ptr, finalspace - ptr) << "\n";
+            out.append(in, ptr, finalspace - ptr);
+            out += '\n';
             if (in[finalspace] == '\n') {
                 indented = 0;
             } else if (indent) {
-                out << std::string(indent, ' ');
+                out.append(indent, ' ');
                 indented = indent;
             }
             ptr = finalspace + 1;
         }
     }
-    return out.str();
+    return out;
 }
 
 int64_t atoi64(const std::string& str)
@@ -582,13 +626,118 @@ std::string Capitalize(std::string str)
 
 std::string HexStr(const Span<const uint8_t> s)
 {
-    std::string rv;
+    std::string rv(s.size() * 2, '\0');
+    HexEncode(s, Span<char>(&rv[0], rv.size()));
+    return rv;
+}
+
+#if defined(__SSE2__)
+/** The hex characters of 16 nibbles (0-15). */
+static inline __m128i HexChars(__m128i nibbles)
+{
+    // '0' + n, and another 'a' - '0' - 10 for n > 9.
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+/** The values of 16 hex characters. valid is set to 0xFF in the bytes which are hex digits. */
+static inline __m128i HexValues(__m128i chars, __m128i& valid)
+{
+    // Signed comparisons, so characters from 0x80 (negative) are neither digits nor letters.
+    const __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    const __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    valid = _mm_or_si128(is_digit, is_letter);
+    const __m128i digits = _mm_and_si128(is_digit, _mm_sub_epi8(chars, _mm_set1_epi8('0')));
+    const __m128i letters = _mm_and_si128(is_letter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    return _mm_or_si128(digits, letters);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/** The hex characters of 16 nibbles (0-15). */
+static inline uint8x16_t HexChars(uint8x16_t nibbles)
+{
+    return vqtbl1q_u8(vld1q_u8((const uint8_t*)"0123456789abcdef"), nibbles);
+}
+
+/** The values of 16 hex characters. valid is set to 0xFF in the bytes which are hex digits. */
+static inline uint8x16_t HexValues(uint8x16_t chars, uint8x16_t& valid)
+{
+    const uint8x16_t digits = vsubq_u8(chars, vdupq_n_u8('0'));
+    const uint8x16_t letters = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t is_digit = vcltq_u8(digits, vdupq_n_u8(10));
+    const uint8x16_t is_letter = vcltq_u8(letters, vdupq_n_u8(6));
+    valid = vorrq_u8(is_digit, is_letter);
+    return vbslq_u8(is_digit, digits, vaddq_u8(letters, vdupq_n_u8(10)));
+}
+#endif
+
+void HexEncode(Span<const uint8_t> s, Span<char> out)
+{
     static constexpr char hexmap[16] = { '0', '1', '2', '3', '4', '5', '6', '7',
                                          '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-    rv.reserve(s.size() * 2);
-    for (uint8_t v: s) {
-        rv.push_back(hexmap[v >> 4]);
-        rv.push_back(hexmap[v & 15]);
+    assert(out.size() >= s.size() * 2);
+    size_t i = 0;
+    char* it = out.data();
+#if defined(__SSE2__)
+    for (; i + 16 <= s.size(); i += 16, it += 32) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(s.data() + i));
+        const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f));
+        const __m128i low = _mm_and_si128(bytes, _mm_set1_epi8(0x0f));
+        // Each high nibble is followed by the low nibble of the same byte.
+        _mm_storeu_si128((__m128i*)it, HexChars(_mm_unpacklo_epi8(high, low)));
+        _mm_storeu_si128((__m128i*)(it + 16), HexChars(_mm_unpackhi_epi8(high, low)));
     }
-    return rv;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= s.size(); i += 16, it += 32) {
+        const uint8x16_t bytes = vld1q_u8(s.data() + i);
+        uint8x16x2_t chars;
+        chars.val[0] = HexChars(vshrq_n_u8(bytes, 4));
+        chars.val[1] = HexChars(vandq_u8(bytes, vdupq_n_u8(0x0f)));
+        vst2q_u8((uint8_t*)it, chars);
+    }
+#endif
+    for (; i < s.size(); ++i) {
+        *it++ = hexmap[s[i] >> 4];
+        *it++ = hexmap[s[i] & 15];
+    }
+}
+
+bool HexDecode(Span<const char> hex, Span<uint8_t> out)
+{
+    if (hex.size() % 2) return false;
+    assert(out.size() >= hex.size() / 2);
+    size_t i = 0;
+    uint8_t* it = out.data();
+#if defined(__SSE2__)
+    __m128i valid = _mm_set1_epi8(-1);
+    for (; i + 32 <= hex.size(); i += 32, it += 16) {
+        __m128i valid1, valid2;
+        const __m128i values1 = HexValues(_mm_loadu_si128((const __m128i*)(hex.data() + i)), valid1);
+        const __m128i values2 = HexValues(_mm_loadu_si128((const __m128i*)(hex.data() + i + 16)), valid2);
+        valid = _mm_and_si128(valid, _mm_and_si128(valid1, valid2));
+        // Each 16-bit lane holds a high nibble (in its low byte) and a low nibble.
+        const __m128i bytes1 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values1, _mm_set1_epi16(0x0f)), 4), _mm_srli_epi16(values1, 8));
+        const __m128i bytes2 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values2, _mm_set1_epi16(0x0f)), 4), _mm_srli_epi16(values2, 8));
+        _mm_storeu_si128((__m128i*)it, _mm_packus_epi16(bytes1, bytes2));
+    }
+    if (_mm_movemask_epi8(valid) != 0xFFFF) return false;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t valid = vdupq_n_u8(0xFF);
+    for (; i + 32 <= hex.size(); i += 32, it += 16) {
+        const uint8x16x2_t chars = vld2q_u8((const uint8_t*)hex.data() + i);
+        uint8x16_t valid_high, valid_low;
+        const uint8x16_t high = HexValues(chars.val[0], valid_high);
+        const uint8x16_t low = HexValues(chars.val[1], valid_low);
+        valid = vandq_u8(valid, vandq_u8(valid_high, valid_low));
+        vst1q_u8(it, vorrq_u8(vshlq_n_u8(high, 4), low));
+    }
+    if (vminvq_u8(valid) == 0) return false;
+#endif
+    for (; i < hex.size(); i += 2) {
+        const signed char high = HexDigit(hex[i]);
+        const signed char low = HexDigit(hex[i + 1]);
+        if (high < 0 || low < 0) return false;
+        *it++ = (high << 4) | low;
+    }
+    return true;
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-// Copied from:
+// Copied from (with the addition of HexEncode, HexDecode, ConvertBits8To5 and ConvertBits5To8, and without the stream-based ParseDouble):
 // https://github.com/bitcoin/bitcoin/blob/master/src/util/strencodings.h
 
 // Copyright (c) 2009-2010 Satoshi Nakamoto
@@ -134,19 +134,26 @@ NODISCARD bool ParseUInt32(const std::string& str, uint32_t *out);
  */
 NODISCARD bool ParseUInt64(const std::string& str, uint64_t *out);
 
-/**
- * Convert string to double with strict parse error feedback.
- * @returns true if the entire string could be parsed as valid double,
- *   false if not the entire string could be parsed or when overflow or underflow occurred.
- */
-NODISCARD bool ParseDouble(const std::string& str, double *out);
-
 /**
  * Convert a span of bytes to a lower-case hexadecimal string.
  */
 std::string HexStr(const Span<const uint8_t> s);
 inline std::string HexStr(const Span<const char> s) { return HexStr(MakeUCharSpan(s)); }
 
+/**
+ * Write the lower-case hexadecimal encoding of s to out, which must have room for 2 * s.size()
+ * characters. Converts 16 bytes at a time where SIMD is available.
+ */
+void HexEncode(Span<const uint8_t> s, Span<char> out);
+
+/**
+ * Decode the hexadecimal string hex into out, which must have room for hex.size() / 2 bytes.
+ * Unlike ParseHex, this is strict: it returns false if hex has an odd length or contains
+ * anything but hex digits (including whitespace). Converts 32 characters at a time where SIMD
+ * is available.
+ */
+NODISCARD bool HexDecode(Span<const char> hex, Span<uint8_t> out);
+
 /**
  * Format a paragraph of text to a fixed width, adding spaces for
  * indentation to any added line.
@@ -199,6 +206,16 @@ bool ConvertBits(const O& outfn, I it, I end) {
     return true;
 }
 
+/** ConvertBits<8, 5, true> into contiguous output, a whole 5-byte group (8 values) per step.
+ *  out must have room for (in.size() * 8 + 4) / 5 values. Returns how many were written. */
+size_t ConvertBits8To5(Span<const uint8_t> in, Span<uint8_t> out);
+
+/** ConvertBits<5, 8, false> into contiguous output, a whole 8-value group (5 bytes) per step.
+ *  The values must be below 32, and out must have room for in.size() * 5 / 8 bytes (which are
+ *  written either way). out may start at in, to convert in place. Returns false if the padding
+ *  is invalid. */
+bool ConvertBits5To8(Span<const uint8_t> in, Span<uint8_t> out);
+
 /**
  * Converts the given character to its lowercase equivalent.
  * This function is locale independent. It only converts uppercase
@@ -1,4 +1,4 @@
-// Copied from:
+// Copied from (without the stream-based ToString):
 // https://github.com/bitcoin/bitcoin/blob/master/src/util/string.h
 
 // Copyright (c) 2019-2020 The Bitcoin Core developers
@@ -13,8 +13,6 @@
 #include <algorithm>
 #include <array>
 #include <cstring>
-#include <locale>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -67,18 +65,6 @@ NODISCARD inline bool ValidAsCString(const std::string& str) noexcept
     return str.size() == strlen(str.c_str());
 }
 
-/**
- * Locale-independent version of std::to_string
- */
-template <typename T>
-std::string ToString(const T& t)
-{
-    std::ostringstream oss;
-    oss.imbue(std::locale::classic());
-    oss << t;
-    return oss.str();
-}
-
 /**
  * Check whether a container begins with the given prefix.
  */
@@ -18,10 +18,17 @@
 // {{WARNING_TEXT}}
 
 #include "lnurl.h"
+#include "pregenerator.h"
 
 #include <unity.h>
+#include <algorithm>
 #include <stdexcept>
 
+#ifdef LNURL_THREADS
+#include <chrono>
+#include <thread>
+#endif
+
 void test_encode(void) {
 	const std::string unencoded = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
 	const std::string expected = "lnurl1dp68gurn8ghj7um9wfmxjcm99e3k7mf0v9cxj0m385ekvcenxc6r2c35xvukxefcv5mkvv34x5ekzd3ev56nyd3hxqurzepexejxxepnxscrvwfnv9nxzcn9xq6xyefhvgcxxcmyxymnserxfq5fns";
@@ -45,7 +52,8 @@ void test_create_signature(void) {
 	config.apiKey.id = "5d4aeb462a";
 	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
 	config.apiKey.encoding = "hex";
-	Lnurl::Signer signer(config);
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
 	Lnurl::WithdrawParams params;
 	params.minWithdrawable = "50000";
 	params.maxWithdrawable = "60000";
@@ -60,6 +68,7 @@ void test_create_signature(void) {
 }
 
 void test_signer_create_url_missing_nonce(void) {
+#ifndef LNURL_NO_EXCEPTIONS
 	Lnurl::SignerConfig config;
 	config.apiKey.id = "5d4aeb462a";
 	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
@@ -81,9 +90,11 @@ void test_signer_create_url_missing_nonce(void) {
 		return;
 	}
 	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
 }
 
 void test_signer_create_url_withdraw_minWithdrawable_lt_zero(void) {
+#ifndef LNURL_NO_EXCEPTIONS
 	Lnurl::SignerConfig config;
 	config.apiKey.id = "5d4aeb462a";
 	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
@@ -106,9 +117,11 @@ void test_signer_create_url_withdraw_minWithdrawable_lt_zero(void) {
 		return;
 	}
 	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
 }
 
 void test_signer_create_url_withdraw_maxWithdrawable_lt_minWithdrawable(void) {
+#ifndef LNURL_NO_EXCEPTIONS
 	Lnurl::SignerConfig config;
 	config.apiKey.id = "5d4aeb462a";
 	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
@@ -131,9 +144,11 @@ void test_signer_create_url_withdraw_maxWithdrawable_lt_minWithdrawable(void) {
 		return;
 	}
 	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
 }
 
 void test_signer_create_url_custom_params_reserved(void) {
+#ifndef LNURL_NO_EXCEPTIONS
 	Lnurl::SignerConfig config;
 	config.apiKey.id = "5d4aeb462a";
 	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
@@ -156,6 +171,1251 @@ void test_signer_create_url_custom_params_reserved(void) {
 		return;
 	}
 	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
+}
+
+void test_create_signature_reuse_signer(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "9Pfv1wY=";
+	config.apiKey.key = "zc5UwZHCrug1GuOTIodVQKFii40gXEDbydClsqs/tIM=";
+	config.apiKey.encoding = "base64";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	const std::string payload = "sign arbitrary data string";
+	const std::string first = signer.create_signature(payload);
+	signer.create_signature("some other payload");
+	const std::string second = signer.create_signature(payload);
+	TEST_ASSERT_EQUAL_STRING(
+		first.c_str(),
+		second.c_str()
+	);
+}
+
+void test_signer_create_url_buffer(void) {
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = true;
+	Lnurl::Signer signer(config);
+	const std::string nonce = "test_buffer";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	params.defaultDescription = "buffer test";
+	params.custom["a"] = "first";
+	params.custom["q"] = "between shortened keys";
+	params.custom["z"] = "last";
+	const std::string expected = signer.create_url(params, nonce);
+	const size_t length = signer.url_length(params, nonce);
+	TEST_ASSERT_EQUAL(expected.size(), length);
+	char output[512];
+	TEST_ASSERT_EQUAL(length, signer.create_url(output, params, nonce));
+	TEST_ASSERT_EQUAL_STRING(
+		expected.c_str(),
+		output
+	);
+#endif
+}
+
+void test_signer_create_url_buffer_too_small(void) {
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = false;
+	Lnurl::Signer signer(config);
+	const std::string nonce = "test_buffer_too_small";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	params.defaultDescription = "";
+	std::vector<char> output(signer.url_length(params, nonce));
+	try {
+		signer.create_url(output, params, nonce);
+	} catch (const std::invalid_argument& e) {
+		TEST_ASSERT_EQUAL_STRING(
+			"Output buffer is too small for the signed URL",
+			e.what()
+		);
+		return;
+	}
+	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
+}
+
+void test_signer_create_urls(void) {
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = true;
+	Lnurl::Signer signer(config);
+	std::vector<Lnurl::WithdrawParams> params(10);
+	std::vector<std::string> nonces(10);
+	for (size_t i = 0; i < params.size(); ++i) {
+		params[i].minWithdrawable = "50000";
+		params[i].maxWithdrawable = std::to_string(50000 + i);
+		nonces[i] = "test_batch_" + std::to_string(i);
+	}
+	const std::vector<std::string> result = signer.create_urls(params, nonces, 4);
+	TEST_ASSERT_EQUAL(params.size(), result.size());
+	for (size_t i = 0; i < params.size(); ++i) {
+		TEST_ASSERT_EQUAL_STRING(
+			signer.create_url(params[i], nonces[i]).c_str(),
+			result[i].c_str()
+		);
+	}
+#endif
+}
+
+void test_hmac_sha256_finalize_multi(void) {
+	const std::vector<unsigned char> key = ParseHex("ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db");
+	CHMAC_SHA256 hasher(key.data(), key.size());
+	// Prefix the messages with some bytes, so that they don't start on a block boundary.
+	const unsigned char prefix[70] = {0};
+	hasher.Write(prefix, sizeof(prefix));
+	// Messages of varying length, in batches that cover every lane width and partial groups.
+	const size_t max_count = 19;
+	std::vector<std::string> messages(max_count);
+	const unsigned char* data[max_count];
+	size_t len[max_count];
+	for (size_t i = 0; i < max_count; ++i) {
+		messages[i] = std::string(i * 29, 'a' + i);
+		data[i] = (const unsigned char*)messages[i].data();
+		len[i] = messages[i].size();
+	}
+	for (const size_t count : std::vector<size_t>{ 1, 3, 4, 8, max_count }) {
+		unsigned char result[max_count * CHMAC_SHA256::OUTPUT_SIZE];
+		hasher.FinalizeMulti(result, data, len, count);
+		for (size_t i = 0; i < count; ++i) {
+			unsigned char expected[CHMAC_SHA256::OUTPUT_SIZE];
+			CHMAC_SHA256(hasher).Write(data[i], len[i]).Finalize(expected);
+			TEST_ASSERT_EQUAL_STRING(
+				HexStr(expected).c_str(),
+				HexStr(Span<const unsigned char>(result + i * CHMAC_SHA256::OUTPUT_SIZE, CHMAC_SHA256::OUTPUT_SIZE)).c_str()
+			);
+		}
+	}
+}
+
+void test_amount(void) {
+	TEST_ASSERT_FALSE(Lnurl::Amount().is_set());
+	TEST_ASSERT_FALSE(Lnurl::Amount("").is_set());
+	TEST_ASSERT_FALSE(Lnurl::Amount("abc").is_valid());
+	TEST_ASSERT_FALSE(Lnurl::Amount("50.5").is_valid());
+	TEST_ASSERT_EQUAL_STRING("50000", Lnurl::Amount(50000).to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("50", Lnurl::Amount("50.00").to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("50000", Lnurl::Amount("5e4").to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("-1", Lnurl::Amount("-1").to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("9223372036854775807", Lnurl::Amount("9223372036854775807").to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("-9223372036854775808", Lnurl::Amount(INT64_MIN).to_string().c_str());
+	TEST_ASSERT_TRUE(Lnurl::Amount("9007199254740993").get_msat() == 9007199254740993LL);
+	// Unsigned values which don't fit an int64_t aren't wrapped around to negative amounts.
+	TEST_ASSERT_EQUAL_STRING("9223372036854775807", Lnurl::Amount(static_cast<uint64_t>(INT64_MAX)).to_string().c_str());
+	TEST_ASSERT_TRUE(Lnurl::Amount(static_cast<uint64_t>(INT64_MAX) + 1).is_set());
+	TEST_ASSERT_FALSE(Lnurl::Amount(static_cast<uint64_t>(INT64_MAX) + 1).is_valid());
+	TEST_ASSERT_FALSE(Lnurl::Amount(UINT64_MAX).is_valid());
+	TEST_ASSERT_TRUE(Lnurl::Amount(50000U).is_valid());
+	// Neither bool nor characters are amounts.
+	TEST_ASSERT_FALSE((std::is_convertible<bool, Lnurl::Amount>::value));
+	TEST_ASSERT_FALSE((std::is_convertible<char, Lnurl::Amount>::value));
+	TEST_ASSERT_FALSE((std::is_convertible<unsigned char, Lnurl::Amount>::value));
+	TEST_ASSERT_TRUE((std::is_convertible<short, Lnurl::Amount>::value));
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = 50000;
+	params.maxWithdrawable = UINT64_MAX;
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	std::string url;
+	TEST_ASSERT_TRUE(signer.create_url(url, params, "nonce") == Lnurl::Status::InvalidMaxWithdrawable);
+}
+
+void test_signer_create_url_withdraw_amount_not_a_number(void) {
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer(config);
+	const std::string nonce = "test";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "50000 msat";
+	params.defaultDescription = "";
+	try {
+		signer.create_url(params, nonce);
+	} catch (const std::invalid_argument& e) {
+		TEST_ASSERT_EQUAL_STRING(
+			"\"maxWithdrawable\" must be a number",
+			e.what()
+		);
+		return;
+	}
+	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
+}
+
+void test_signer_create_url_withdraw_amount_exact(void) {
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer(config);
+	const std::string nonce = "test";
+	Lnurl::WithdrawParams params;
+	// Equal as doubles (2^53 + 1 rounds to 2^53), but not as msat.
+	params.minWithdrawable = "9007199254740993";
+	params.maxWithdrawable = 9007199254740992LL;
+	params.defaultDescription = "";
+	try {
+		signer.create_url(params, nonce);
+	} catch (const std::invalid_argument& e) {
+		TEST_ASSERT_EQUAL_STRING(
+			"\"maxWithdrawable\" must be greater than or equal to \"minWithdrawable\"",
+			e.what()
+		);
+		return;
+	}
+	TEST_FAIL_MESSAGE("Expected exception to be thrown");
+#endif
+}
+
+void test_signer_create_url_flat_query(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = true;
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	Lnurl::Query query;
+	query["tag"] = "withdrawRequest";
+	query["minWithdrawable"] = "50000";
+	query["maxWithdrawable"] = "60000";
+	query["nonce"] = "test_flat_query";
+	query["id"] = "5d4aeb462a";
+	query["defaultDescription"] = "flat query";
+	query["custom"] = "custom param";
+	// Same params, added out of order and with one value replaced.
+	Lnurl::FlatQuery flatQuery;
+	flatQuery.set("nonce", "test_flat_query");
+	flatQuery.set("tag", "withdrawRequest");
+	flatQuery.set("custom", "replaced");
+	flatQuery.set("minWithdrawable", "50000");
+	flatQuery.set("maxWithdrawable", "60000");
+	flatQuery.set("id", "5d4aeb462a");
+	flatQuery.set("defaultDescription", "flat query");
+	flatQuery.set("custom", "custom param");
+	TEST_ASSERT_EQUAL(query.size(), flatQuery.size());
+	TEST_ASSERT_EQUAL(0, flatQuery.find(Span<const char>("custom", 6)));
+	const std::string expected = signer.create_url(query);
+	TEST_ASSERT_EQUAL_STRING(
+		expected.c_str(),
+		signer.create_url(flatQuery).c_str()
+	);
+	TEST_ASSERT_EQUAL_STRING(
+		expected.c_str(),
+		signer.create_url(Lnurl::FlatQuery(query)).c_str()
+	);
+}
+
+void test_signer_create_url_matches_query(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = false;
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	const std::string nonce = "test_matches_query";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	params.defaultDescription = "single pass";
+	// Custom params sorted before the first, between and after the signed params and the signature.
+	params.custom["a"] = "first";
+	params.custom["q"] = "before signature";
+	params.custom["sz"] = "after signature";
+	params.custom["zz"] = "last";
+	Lnurl::Query query = params.custom;
+	query["defaultDescription"] = "single pass";
+	query["id"] = "5d4aeb462a";
+	query["maxWithdrawable"] = "60000";
+	query["minWithdrawable"] = "50000";
+	query["nonce"] = nonce;
+	query["tag"] = "withdrawRequest";
+	std::string url;
+	TEST_ASSERT_TRUE(signer.create_url(url, params, nonce) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(
+		signer.create_url(query).c_str(),
+		url.c_str()
+	);
+}
+
+void test_sha256_midstate(void) {
+	const std::string prefix(100, 'p');
+	const std::string suffix = "suffix";
+	CSHA256 hasher;
+	hasher.Write((const unsigned char*)prefix.data(), prefix.size());
+	unsigned char midstate[CSHA256::MIDSTATE_SIZE];
+	hasher.GetMidstate(midstate);
+	unsigned char expected[CSHA256::OUTPUT_SIZE];
+	hasher.Write((const unsigned char*)suffix.data(), suffix.size()).Finalize(expected);
+	unsigned char result[CSHA256::OUTPUT_SIZE];
+	CSHA256().SetMidstate(midstate).Write((const unsigned char*)suffix.data(), suffix.size()).Finalize(result);
+	TEST_ASSERT_EQUAL_STRING(
+		HexStr(expected).c_str(),
+		HexStr(result).c_str()
+	);
+}
+
+void test_signer_create_template(void) {
+#ifndef LNURL_NO_EXCEPTIONS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	params.defaultDescription = "template test";
+	params.custom["a"] = "first";
+	params.custom["o"] = "after nonce";
+	params.custom["z"] = "last";
+	for (const bool shorten : { false, true }) {
+		config.shorten = shorten;
+		Lnurl::Signer signer(config);
+		const Lnurl::SigningTemplate t_template = signer.create_template(params);
+		for (const std::string nonce : { "1", "test_template", "needs escaping & more" }) {
+			const std::string expected = signer.create_url(params, nonce);
+			TEST_ASSERT_EQUAL(expected.size(), t_template.url_length(nonce));
+			TEST_ASSERT_EQUAL_STRING(
+				expected.c_str(),
+				t_template.create_url(nonce).c_str()
+			);
+		}
+	}
+#endif
+}
+
+void test_bech32_span(void) {
+	const std::string encoded = "lnurl1dp68gurn8ghj7um9wfmxjcm99e3k7mf0v9cxj0m385ekvcenxc6r2c35xvukxefcv5mkvv34x5ekzd3ev56nyd3hxqurzepexejxxepnxscrvwfnv9nxzcn9xq6xyefhvgcxxcmyxymnserxfq5fns";
+	char hrp[256];
+	uint8_t values[256];
+	size_t hrpLength, valuesLength;
+	TEST_ASSERT_TRUE(bech32::Decode(encoded, hrp, hrpLength, values, valuesLength));
+	TEST_ASSERT_EQUAL_STRING("lnurl", std::string(hrp, hrpLength).c_str());
+	char out[256];
+	const size_t length = bech32::Encode(out, Span<const char>(hrp, hrpLength), Span<const uint8_t>(values, valuesLength));
+	TEST_ASSERT_EQUAL_STRING(encoded.c_str(), std::string(out, length).c_str());
+	TEST_ASSERT_EQUAL_UINT(0, bech32::Encode(Span<char>(out, length - 1), Span<const char>(hrp, hrpLength), Span<const uint8_t>(values, valuesLength)));
+	TEST_ASSERT_FALSE(bech32::Decode(encoded, Span<char>(hrp, 4), hrpLength, values, valuesLength));
+	std::string corrupted = encoded;
+	corrupted[10] = 'q';
+	TEST_ASSERT_FALSE(bech32::Decode(corrupted, hrp, hrpLength, values, valuesLength));
+}
+
+void test_bech32_checksum(void) {
+	// Valid test vectors from BIP 173, which exercise HRPs other than "lnurl" and odd lengths.
+	const std::vector<std::string> valid = {
+		"A12UEL5L",
+		"a12uel5l",
+		"an83characterlonghumanreadablepartthatcontainsthenumber1andtheexcludedcharactersbio1tt5tgs",
+		"abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw",
+		"split1checkupstagehandshakeupstreamerranterredcaperred2y9e3w",
+	};
+	for (const std::string &str : valid) {
+		const std::pair<std::string, std::vector<uint8_t>> decoded = bech32::Decode(str);
+		TEST_ASSERT_FALSE(decoded.first.empty());
+		std::string lower = str;
+		std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+		TEST_ASSERT_EQUAL_STRING(lower.c_str(), bech32::Encode(decoded.first, decoded.second).c_str());
+	}
+	TEST_ASSERT_TRUE(bech32::Decode("a12uel5m").first.empty());
+}
+
+void test_encode_decode_lengths(void) {
+	// Every remainder of the 5-byte groups, and bytes outside of ASCII.
+	for (size_t length = 0; length <= 11; length++) {
+		std::string unencoded;
+		for (size_t i = 0; i < length; i++) {
+			unencoded.push_back((char)(0xf5 - 37 * i));
+		}
+		const std::string encoded = Lnurl::encode(unencoded);
+		TEST_ASSERT_EQUAL_UINT(5 + 1 + (length * 8 + 4) / 5 + 6, encoded.size());
+		TEST_ASSERT_TRUE(Lnurl::decode(encoded) == unencoded);
+	}
+}
+
+void test_encode_uppercase(void) {
+	const std::string unencoded = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+	const std::string expected = "LNURL1DP68GURN8GHJ7UM9WFMXJCM99E3K7MF0V9CXJ0M385EKVCENXC6R2C35XVUKXEFCV5MKVV34X5EKZD3EV56NYD3HXQURZEPEXEJXXEPNXSCRVWFNV9NXZCN9XQ6XYEFHVGCXXCMYXYMNSERXFQ5FNS";
+	TEST_ASSERT_EQUAL_STRING(
+		expected.c_str(),
+		Lnurl::encode(unencoded, true).c_str()
+	);
+	TEST_ASSERT_EQUAL_STRING(
+		unencoded.c_str(),
+		Lnurl::decode(expected).c_str()
+	);
+}
+
+void test_qrcode(void) {
+	const std::string lnurl = Lnurl::encode("https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df", true);
+	uint8_t buffer[Lnurl::QrCode::buffer_size(8)];
+	Lnurl::QrCode qr;
+	TEST_ASSERT_TRUE(qr.encode(lnurl, buffer) == Lnurl::Status::Ok);
+	// 156 alphanumeric characters take version 7 at level M (byte mode would take version 9).
+	TEST_ASSERT_EQUAL_INT(7, qr.get_version());
+	TEST_ASSERT_EQUAL_INT(45, qr.get_size());
+	TEST_ASSERT_TRUE(qr.get_mask() >= 0 && qr.get_mask() <= 7);
+	// Finder patterns, timing patterns and the dark module.
+	const int corners[3][2] = { { 0, 0 }, { 38, 0 }, { 0, 38 } };
+	for (const auto &corner : corners) {
+		TEST_ASSERT_TRUE(qr.get_module(corner[0], corner[1]));
+		TEST_ASSERT_FALSE(qr.get_module(corner[0] + 1, corner[1] + 1));
+		TEST_ASSERT_TRUE(qr.get_module(corner[0] + 3, corner[1] + 3));
+	}
+	TEST_ASSERT_TRUE(qr.get_module(8, 6));
+	TEST_ASSERT_FALSE(qr.get_module(6, 9));
+	TEST_ASSERT_TRUE(qr.get_module(8, 37));
+	// "HELLO WORLD" at version 1-M with mask 2. The codewords are 20 5B 0B 78 D1 72 DC 4D 43 40
+	// EC 11 EC 11 EC 11 (data and padding) and C4 23 27 77 EB D7 E7 E2 5D 17 (error correction),
+	// and the format bits are 101111001111100.
+	const char* const helloWorld[21] = {
+		"#######..#..#.#######",
+		"#.....#..####.#.....#",
+		"#.###.#.##..#.#.###.#",
+		"#.###.#.#.##..#.###.#",
+		"#.###.#.##.##.#.###.#",
+		"#.....#.###.#.#.....#",
+		"#######.#.#.#.#######",
+		"........#..##........",
+		"#.#####...#.#.#####..",
+		"#.####.##...##..#####",
+		"..#..###..##...#.#..#",
+		"..##....#......#.....",
+		".###.####.##......#..",
+		"........#.#####..#.##",
+		"#######..##.#.#.###.#",
+		"#.....#.########..##.",
+		"#.###.#.#.#.#....###.",
+		"#.###.#.#.#.#..#.##..",
+		"#.###.#.#..#.#..##...",
+		"#.....#...........#.#",
+		"#######.#.##.#..#...."
+	};
+	uint8_t helloWorldBuffer[Lnurl::QrCode::buffer_size(1)];
+	Lnurl::QrCode known;
+	TEST_ASSERT_TRUE(known.encode(Span<const char>("HELLO WORLD", 11), helloWorldBuffer, Lnurl::QrCode::Ecc::Medium, 2) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_INT(1, known.get_version());
+	TEST_ASSERT_EQUAL_INT(2, known.get_mask());
+	TEST_ASSERT_EQUAL_INT(21, known.get_size());
+	for (int y = 0; y < 21; y++) {
+		std::string row;
+		for (int x = 0; x < 21; x++) {
+			row += known.get_module(x, y) ? '#' : '.';
+		}
+		TEST_ASSERT_EQUAL_STRING(helloWorld[y], row.c_str());
+	}
+	// Version 3-Q with mask 5 has two blocks (17 data and 18 error correction codewords each),
+	// so the codewords are interleaved.
+	const char* const twoBlocks[29] = {
+		"#######.####.#.#...##.#######",
+		"#.....#.#..##.#.#...#.#.....#",
+		"#.###.#..#..#..##.#...#.###.#",
+		"#.###.#.....#.#####...#.###.#",
+		"#.###.#...#.##.#.#.#..#.###.#",
+		"#.....#..#.#.#...#.#..#.....#",
+		"#######.#.#.#.#.#.#.#.#######",
+		"..........#....####..........",
+		".#....###...#.#.#..#.#.....##",
+		".#####..###.###.#.#...#..#..#",
+		".######.####.#....##.#.######",
+		".#......##.#.#.#...###..##...",
+		"..#.###.###.#######..##.##...",
+		"...###..##....#...#.##..#.###",
+		"#..#####...#..#.#.#.####..#.#",
+		"..#.#..##.#.#####..####.##.#.",
+		"....###.#.##..##..#..####..##",
+		"###..#....#..##.#....###.####",
+		"##....##..#.#...#.###.######.",
+		"#.#.#..###..#######...##.#.#.",
+		"#.##.####.#####..##.#####.##.",
+		"........##.#.###.#.##...#.##.",
+		"#######.######..##..#.#.#.#..",
+		"#.....#...#......####...####.",
+		"#.###.#....#.....#..######...",
+		"#.###.#...#.###...##.#.#####.",
+		"#.###.#...#...#######....###.",
+		"#.....#.#...##..###.#.#.#....",
+		"#######.....#..###.##..#.#.#."
+	};
+	uint8_t twoBlocksBuffer[Lnurl::QrCode::buffer_size(3)];
+	Lnurl::QrCode interleaved;
+	TEST_ASSERT_TRUE(interleaved.encode(Span<const char>("LNURL1DP68GURN8GHJ7UM9WFMXJCM99E3K7", 35), twoBlocksBuffer, Lnurl::QrCode::Ecc::Quartile, 5) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_INT(3, interleaved.get_version());
+	for (int y = 0; y < 29; y++) {
+		std::string row;
+		for (int x = 0; x < 29; x++) {
+			row += interleaved.get_module(x, y) ? '#' : '.';
+		}
+		TEST_ASSERT_EQUAL_STRING(twoBlocks[y], row.c_str());
+	}
+#ifndef LNURL_NO_EXCEPTIONS
+	try {
+		Lnurl::QrCode lowercase(Lnurl::encode("https://service.com"), buffer);
+		TEST_FAIL_MESSAGE("Expected an exception for lowercase text");
+	} catch (const std::invalid_argument &e) {
+		TEST_ASSERT_EQUAL_STRING("QR code text must be alphanumeric (0-9, A-Z, space and $%*+-./:)", e.what());
+	}
+	try {
+		Lnurl::QrCode tooSmall(lnurl, Span<uint8_t>(buffer, Lnurl::QrCode::buffer_size(7) - 1));
+		TEST_FAIL_MESSAGE("Expected an exception for a small buffer");
+	} catch (const std::invalid_argument &e) {
+		TEST_ASSERT_EQUAL_STRING("Buffer is too small for the QR code", e.what());
+	}
+#endif
+}
+
+void test_decoder_chunks(void) {
+	// Longer than bech32::Decode accepts (1023 characters).
+	std::string unencoded = "https://service.com/api?q=";
+	while (unencoded.size() < 1000) {
+		unencoded += "3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+	}
+	const std::string encoded = Lnurl::encode(unencoded);
+	TEST_ASSERT_TRUE(encoded.size() > 1023);
+	Lnurl::Decoder decoder;
+	std::string decoded;
+	char output[Lnurl::Decoder::max_output(7)];
+	for (size_t i = 0; i < encoded.size(); i += 7) {
+		size_t length;
+		TEST_ASSERT_TRUE(decoder.update(Span<const char>(encoded.data() + i, std::min<size_t>(7, encoded.size() - i)), output, length) == Lnurl::Status::Ok);
+		decoded.append(output, length);
+	}
+	TEST_ASSERT_TRUE(decoder.finish());
+	TEST_ASSERT_EQUAL_STRING("lnurl", std::string(decoder.hrp().begin(), decoder.hrp().end()).c_str());
+	TEST_ASSERT_EQUAL_STRING(unencoded.c_str(), decoded.c_str());
+	// Corrupted checksum.
+	std::string corrupted = encoded;
+	corrupted[encoded.size() - 1] = corrupted[encoded.size() - 1] == 'q' ? 'p' : 'q';
+	decoder.reset();
+	char whole[Lnurl::Decoder::max_output(2048)];
+	size_t length;
+	decoder.update(corrupted, whole, length);
+	TEST_ASSERT_FALSE(decoder.finish());
+	// Mixed case.
+	decoder.reset();
+	decoder.update(Span<const char>("LNURL1dp68", 10), whole, length);
+	TEST_ASSERT_TRUE(decoder.failed());
+}
+
+void test_decode_batch(void) {
+	const std::string url = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+	const std::string encoded = Lnurl::encode(url);
+	std::string corrupted = encoded;
+	corrupted[encoded.size() - 1] = corrupted[encoded.size() - 1] == 'q' ? 'p' : 'q';
+	std::string mixedCase = encoded;
+	mixedCase[0] = 'L';
+	std::vector<std::string> inputs = {
+		encoded,
+		Lnurl::encode(url, true),
+		corrupted,
+		mixedCase,
+		"",
+		bech32::Encode("other", std::vector<uint8_t>(10, 0)),
+		Lnurl::encode("a"),
+	};
+	// More than one group of lanes, of different lengths.
+	for (int i = 0; i < 10; i++) {
+		inputs.push_back(Lnurl::encode(url.substr(0, 10 * i)));
+	}
+	const std::vector<Lnurl::DecodeResult> results = Lnurl::decode_batch(inputs);
+	TEST_ASSERT_EQUAL_INT(inputs.size(), results.size());
+	const bool valid[] = { true, true, false, false, false, false, true };
+	for (size_t i = 0; i < inputs.size(); i++) {
+		TEST_ASSERT_EQUAL(i < 7 ? valid[i] : true, results[i].valid);
+		if (results[i].valid) {
+			TEST_ASSERT_EQUAL_STRING(Lnurl::decode(inputs[i]).c_str(), results[i].url.c_str());
+		} else {
+			TEST_ASSERT_EQUAL_STRING("", results[i].url.c_str());
+		}
+	}
+	// Same results as bech32::Decode.
+	const std::vector<std::pair<std::string, std::vector<uint8_t>>> decoded = bech32::DecodeBatch(inputs);
+	for (size_t i = 0; i < inputs.size(); i++) {
+		TEST_ASSERT_TRUE(decoded[i] == bech32::Decode(inputs[i]));
+	}
+	TEST_ASSERT_EQUAL_STRING("other", decoded[5].first.c_str());
+	// The lengths of a lane which fails its checksum are left alone.
+	char hrpBuffers[2][200];
+	uint8_t valueBuffers[2][200];
+	const Span<const char> lanes[2] = { inputs[0], inputs[2] };
+	const Span<char> hrps[2] = { hrpBuffers[0], hrpBuffers[1] };
+	const Span<uint8_t> values[2] = { valueBuffers[0], valueBuffers[1] };
+	size_t hrpLens[2] = { 99, 99 };
+	size_t valuesLens[2] = { 99, 99 };
+	TEST_ASSERT_EQUAL_UINT(1, bech32::DecodeLanes(lanes, 2, hrps, hrpLens, values, valuesLens));
+	TEST_ASSERT_EQUAL_UINT(5, hrpLens[0]);
+	TEST_ASSERT_EQUAL_UINT(decoded[0].second.size(), valuesLens[0]);
+	TEST_ASSERT_EQUAL_UINT(99, hrpLens[1]);
+	TEST_ASSERT_EQUAL_UINT(99, valuesLens[1]);
+}
+
+void test_convert_bits_kernels(void) {
+	// Same results as the generic ConvertBits, for every length of the last group.
+	std::vector<uint8_t> bytes;
+	for (int i = 0; i < 23; i++) {
+		std::vector<uint8_t> expected;
+		ConvertBits<8, 5, true>([&](uint8_t v) { expected.push_back(v); }, bytes.begin(), bytes.end());
+		std::vector<uint8_t> values((bytes.size() * 8 + 4) / 5);
+		TEST_ASSERT_EQUAL_INT(values.size(), ConvertBits8To5(bytes, values));
+		TEST_ASSERT_TRUE(expected == values);
+		std::vector<uint8_t> decoded(values.size() * 5 / 8);
+		TEST_ASSERT_TRUE(ConvertBits5To8(values, decoded));
+		TEST_ASSERT_TRUE(bytes == decoded);
+		bytes.push_back(static_cast<uint8_t>(i * 37 + 11));
+	}
+	// Invalid padding: a whole value of it, or bits which aren't zero.
+	const uint8_t threeValues[] = { 1, 2, 3 };
+	const uint8_t nonZeroPadding[] = { 1, 2, 3, 4 };
+	uint8_t output[2];
+	TEST_ASSERT_FALSE(ConvertBits5To8(threeValues, output));
+	TEST_ASSERT_FALSE(ConvertBits5To8(nonZeroPadding, output));
+	// In place.
+	std::vector<uint8_t> buffer = { 13, 1, 18, 22, 24, 27, 3, 15 };
+	TEST_ASSERT_TRUE(ConvertBits5To8(buffer, buffer));
+	TEST_ASSERT_EQUAL_STRING("hello", std::string(buffer.begin(), buffer.begin() + 5).c_str());
+}
+
+void test_hex_codec(void) {
+	// Long enough for the SIMD blocks, and a tail.
+	std::vector<uint8_t> bytes;
+	for (int i = 0; i < 53; i++) {
+		bytes.push_back(static_cast<uint8_t>(i * 73 + 5));
+	}
+	std::string expected;
+	const char* digits = "0123456789abcdef";
+	for (const uint8_t b : bytes) {
+		expected += digits[b >> 4];
+		expected += digits[b & 15];
+	}
+	char hex[106];
+	HexEncode(bytes, hex);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), std::string(hex, sizeof(hex)).c_str());
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), HexStr(bytes).c_str());
+	uint8_t decoded[53];
+	TEST_ASSERT_TRUE(HexDecode(expected, decoded));
+	TEST_ASSERT_TRUE(std::equal(bytes.begin(), bytes.end(), decoded));
+	// Uppercase.
+	std::string upper = expected;
+	std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+	TEST_ASSERT_TRUE(HexDecode(upper, decoded));
+	TEST_ASSERT_TRUE(std::equal(bytes.begin(), bytes.end(), decoded));
+	// Strict: no odd length, whitespace or other characters (in a block or in the tail).
+	TEST_ASSERT_FALSE(HexDecode(expected.substr(1), decoded));
+	const char invalid[] = { ' ', 'g', 'G', '/', ':', '@', '`', '\xc1' };
+	for (const size_t position : { size_t(3), size_t(101) }) {
+		for (const char c : invalid) {
+			std::string corrupted = expected;
+			corrupted[position] = c;
+			TEST_ASSERT_FALSE(HexDecode(corrupted, decoded));
+		}
+	}
+	// ParseHex still skips whitespace, and stops at the first other character.
+	TEST_ASSERT_TRUE(ParseHex(expected) == bytes);
+	const std::vector<uint8_t> parsed = ParseHex(expected.substr(0, 40) + " " + expected.substr(40, 30) + "x" + expected.substr(70));
+	TEST_ASSERT_EQUAL_INT(35, parsed.size());
+	TEST_ASSERT_TRUE(std::equal(parsed.begin(), parsed.end(), bytes.begin()));
+}
+
+void test_status_codes(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "utf8";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = false;
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::UnsupportedKeyEncoding);
+	config.apiKey.encoding = "hex";
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	const std::string nonce = "test";
+	std::string url;
+	TEST_ASSERT_TRUE(signer.create_url(url, params, "") == Lnurl::Status::MissingNonce);
+	TEST_ASSERT_TRUE(signer.create_url(url, params, nonce) == Lnurl::Status::Ok);
+#ifndef LNURL_NO_EXCEPTIONS
+	TEST_ASSERT_EQUAL_STRING(signer.create_url(params, nonce).c_str(), url.c_str());
+#endif
+	size_t length;
+	TEST_ASSERT_TRUE(signer.url_length(length, params, nonce) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL(url.size(), length);
+	std::vector<char> output(length);
+	TEST_ASSERT_TRUE(signer.create_url(output, length, params, nonce) == Lnurl::Status::UrlBufferTooSmall);
+	TEST_ASSERT_EQUAL_STRING(
+		"Output buffer is too small for the signed URL",
+		Lnurl::status_message(Lnurl::Status::UrlBufferTooSmall)
+	);
+	Lnurl::SigningTemplate t_template;
+	// A template which create_template didn't prepare can't sign.
+	std::string templateUrl;
+	TEST_ASSERT_TRUE(t_template.create_url(templateUrl, nonce) == Lnurl::Status::TemplateNotPrepared);
+	TEST_ASSERT_TRUE(t_template.url_length(length, nonce) == Lnurl::Status::TemplateNotPrepared);
+	TEST_ASSERT_TRUE(t_template.create_url(output, length, nonce) == Lnurl::Status::TemplateNotPrepared);
+	TEST_ASSERT_TRUE(t_template.lnurl_length(length, nonce) == Lnurl::Status::TemplateNotPrepared);
+	TEST_ASSERT_TRUE(t_template.create_lnurl(output, length, nonce) == Lnurl::Status::TemplateNotPrepared);
+	TEST_ASSERT_TRUE(signer.create_template(t_template, params) == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(t_template.create_url(templateUrl, "") == Lnurl::Status::MissingNonce);
+	TEST_ASSERT_TRUE(t_template.create_url(templateUrl, nonce) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(url.c_str(), templateUrl.c_str());
+	// The first invalid params (by input order) decide the status.
+	std::vector<Lnurl::WithdrawParams> batch(20, params);
+	batch[5].custom["signature"] = "x";
+	batch[15].maxWithdrawable = "40000";
+	std::vector<std::string> urls;
+	TEST_ASSERT_TRUE(signer.create_urls(urls, batch, std::vector<std::string>(19, nonce), 4) == Lnurl::Status::NonceCountMismatch);
+	TEST_ASSERT_TRUE(signer.create_urls(urls, batch, std::vector<std::string>(20, nonce), 4) == Lnurl::Status::ReservedCustomParamKey);
+	batch[5].custom.clear();
+	TEST_ASSERT_TRUE(signer.create_urls(urls, batch, std::vector<std::string>(20, nonce), 4) == Lnurl::Status::MaxWithdrawableBelowMin);
+	// Decoder and QR code.
+	Lnurl::Decoder decoder;
+	char chunk[4];
+	TEST_ASSERT_TRUE(decoder.update(Span<const char>("lnurl1dp68", 10), chunk, length) == Lnurl::Status::ChunkBufferTooSmall);
+	Lnurl::QrCode qr;
+	uint8_t buffer[Lnurl::QrCode::buffer_size(1)];
+	TEST_ASSERT_TRUE(qr.encode(Span<const char>("lnurl", 5), buffer) == Lnurl::Status::QrCodeTextNotAlphanumeric);
+	TEST_ASSERT_TRUE(qr.encode(Span<const char>("LNURL", 5), buffer, Lnurl::QrCode::Ecc::Medium, 8) == Lnurl::Status::QrCodeInvalidMask);
+	TEST_ASSERT_TRUE(qr.encode(Span<const char>("LNURL1DP68GURN8GHJ7UM9WFMXJCM99E", 32), buffer) == Lnurl::Status::QrCodeBufferTooSmall);
+	TEST_ASSERT_TRUE(qr.encode(Span<const char>("LNURL", 5), buffer) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL(1, qr.get_version());
+}
+
+void test_string_view(void) {
+	// A received packet: the LNURL is followed by more data, and isn't NUL-terminated.
+	const std::string url = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+	const std::string encoded = Lnurl::encode(url);
+	std::vector<char> packet(encoded.begin(), encoded.end());
+	packet.insert(packet.end(), 8, 'x');
+	const Lnurl::StringView view(packet.data(), encoded.size());
+	TEST_ASSERT_EQUAL_STRING(url.c_str(), Lnurl::decode(view).c_str());
+	TEST_ASSERT_EQUAL_STRING(encoded.c_str(), Lnurl::encode(Lnurl::decode(view)).c_str());
+	TEST_ASSERT_EQUAL_STRING(encoded.c_str(), Lnurl::encode(Span<const char>(url)).c_str());
+	TEST_ASSERT_EQUAL_STRING(url.c_str(), Lnurl::StringView(url.c_str()).to_string().c_str());
+	TEST_ASSERT_EQUAL(0, Lnurl::StringView(nullptr).size());
+	const Lnurl::StringView views[2] = { view, Lnurl::StringView(packet.data(), encoded.size() - 1) };
+	const std::vector<Lnurl::DecodeResult> results = Lnurl::decode_batch(views);
+	TEST_ASSERT_TRUE(results[0].valid);
+	TEST_ASSERT_EQUAL_STRING(url.c_str(), results[0].url.c_str());
+	TEST_ASSERT_FALSE(results[1].valid);
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	const std::string payload = "id=5d4aeb462a&nonce=test";
+	TEST_ASSERT_EQUAL_STRING(
+		signer.create_signature(payload).c_str(),
+		signer.create_signature("id=5d4aeb462a&nonce=test").c_str()
+	);
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	const char nonces[] = { 'n', 'o', 'n', 'c', 'e', '1', 'n', 'o', 'n', 'c', 'e', '2' };
+	std::string expected;
+	TEST_ASSERT_TRUE(signer.create_url(expected, params, "nonce2") == Lnurl::Status::Ok);
+	std::string result;
+	TEST_ASSERT_TRUE(signer.create_url(result, params, Lnurl::StringView(nonces + 6, 6)) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), result.c_str());
+	Lnurl::SigningTemplate t_template;
+	TEST_ASSERT_TRUE(signer.create_template(t_template, params) == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(t_template.create_url(result, Lnurl::StringView(nonces + 6, 6)) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), result.c_str());
+}
+
+void test_arena(void) {
+	uint8_t buffer[600];
+	Lnurl::Arena arena(buffer);
+	TEST_ASSERT_EQUAL(sizeof(buffer), arena.capacity());
+	const std::string url = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+	Lnurl::StringView encoded;
+	TEST_ASSERT_TRUE(Lnurl::encode(arena, encoded, url) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(Lnurl::encode(url).c_str(), encoded.data());
+	TEST_ASSERT_EQUAL(encoded.size() + 1, arena.used());
+	Lnurl::StringView decoded;
+	TEST_ASSERT_TRUE(Lnurl::decode(arena, decoded, encoded) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(url.c_str(), decoded.data());
+	// Only the URL is kept: the rest of the scratch memory is freed.
+	TEST_ASSERT_EQUAL(encoded.size() + 1 + url.size() + 1, arena.used());
+	const size_t mark = arena.mark();
+	TEST_ASSERT_TRUE(Lnurl::decode(arena, decoded, Span<const char>(encoded).first(encoded.size() - 1)) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL(0, decoded.size());
+	TEST_ASSERT_EQUAL(mark, arena.used());
+	// Decoding needs scratch memory for twice the size of the LNURL.
+	TEST_ASSERT_TRUE(arena.allocate(arena.capacity() - arena.used() - 2 * encoded.size() + 1) != nullptr);
+	const size_t full = arena.mark();
+	TEST_ASSERT_TRUE(Lnurl::decode(arena, decoded, encoded) == Lnurl::Status::ArenaExhausted);
+	TEST_ASSERT_EQUAL(full, arena.used());
+	arena.reset();
+	TEST_ASSERT_EQUAL(0, arena.used());
+	TEST_ASSERT_TRUE(arena.allocate(1) != nullptr);
+	TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(arena.allocate(8, 8)) % 8);
+	TEST_ASSERT_TRUE(arena.allocate(sizeof(buffer)) == nullptr);
+	arena.reset();
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	std::string expected;
+	TEST_ASSERT_TRUE(signer.create_url(expected, params, "test") == Lnurl::Status::Ok);
+	Lnurl::StringView signedUrl;
+	TEST_ASSERT_TRUE(signer.create_url(arena, signedUrl, params, "test") == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), signedUrl.data());
+	Lnurl::SigningTemplate t_template;
+	TEST_ASSERT_TRUE(signer.create_template(t_template, params) == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(t_template.create_url(arena, signedUrl, "test") == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), signedUrl.data());
+	TEST_ASSERT_TRUE(t_template.create_url(arena, signedUrl, "test") == Lnurl::Status::ArenaExhausted);
+	TEST_ASSERT_TRUE(signer.create_url(arena, signedUrl, params, "") == Lnurl::Status::MissingNonce);
+}
+
+void test_signer_shared_between_threads(void) {
+#ifdef LNURL_THREADS
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer t_signer;
+	TEST_ASSERT_TRUE(t_signer.set_config(config) == Lnurl::Status::Ok);
+	const Lnurl::Signer &signer = t_signer;
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	const size_t count = 200;
+	std::vector<std::string> expected(count);
+	for (size_t i = 0; i < count; i++) {
+		TEST_ASSERT_TRUE(signer.create_url(expected[i], params, std::to_string(i)) == Lnurl::Status::Ok);
+	}
+	// Every thread signs all nonces with the same signer, without locking.
+	std::vector<std::vector<std::string>> results(4, std::vector<std::string>(count));
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < results.size(); t++) {
+		threads.emplace_back([&signer, &params, &results, t, count]() {
+			for (size_t i = 0; i < count; i++) {
+				signer.create_url(results[t][i], params, std::to_string(i));
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	for (size_t t = 0; t < results.size(); t++) {
+		for (size_t i = 0; i < count; i++) {
+			TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), results[t][i].c_str());
+		}
+	}
+#else
+	TEST_IGNORE_MESSAGE("Signing is sequential in this build");
+#endif
+}
+
+void test_pregenerator(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	unsigned int counter = 0;
+	const auto nonceGenerator = [&counter](Span<char> nonce) -> size_t {
+		const std::string t_nonce = "nonce " + std::to_string(++counter);
+		if (t_nonce.size() > nonce.size()) {
+			return 0;
+		}
+		std::copy(t_nonce.begin(), t_nonce.end(), nonce.begin());
+		return t_nonce.size();
+	};
+	Lnurl::Pregenerator pregenerator;
+	TEST_ASSERT_TRUE(pregenerator.front().empty());
+	TEST_ASSERT_TRUE(pregenerator.init(signer, params, 3, 10, nonceGenerator, true) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL(3, pregenerator.capacity());
+	TEST_ASSERT_EQUAL(3, pregenerator.fill());
+	TEST_ASSERT_EQUAL(0, pregenerator.fill());
+	TEST_ASSERT_EQUAL(3, pregenerator.size());
+	std::string expected;
+	TEST_ASSERT_TRUE(signer.create_url(expected, params, "nonce 1") == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(Lnurl::encode(expected, true).c_str(), pregenerator.front().data());
+	pregenerator.pop();
+	TEST_ASSERT_EQUAL(2, pregenerator.size());
+	TEST_ASSERT_EQUAL(1, pregenerator.fill());
+	// The oldest LNURL comes first, and the ring wraps around.
+	for (unsigned int i = 2; i <= 5; i++) {
+		TEST_ASSERT_TRUE(signer.create_url(expected, params, "nonce " + std::to_string(i)) == Lnurl::Status::Ok);
+		TEST_ASSERT_EQUAL_STRING(Lnurl::encode(expected, true).c_str(), pregenerator.front().data());
+		pregenerator.pop();
+		pregenerator.fill();
+	}
+	// Nonces longer than the maximum aren't used.
+	counter = 999999;
+	while (pregenerator.size() > 0) {
+		pregenerator.pop();
+	}
+	TEST_ASSERT_EQUAL(0, pregenerator.fill());
+#ifdef LNURL_THREADS
+	counter = 100;
+	TEST_ASSERT_TRUE(pregenerator.start(1));
+	std::vector<std::string> urls;
+	while (urls.size() < 20) {
+		const Lnurl::StringView lnurl = pregenerator.front();
+		if (lnurl.empty()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		urls.push_back(Lnurl::decode(lnurl));
+		pregenerator.pop();
+	}
+	pregenerator.stop();
+	for (size_t i = 0; i < urls.size(); i++) {
+		TEST_ASSERT_TRUE(signer.create_url(expected, params, "nonce " + std::to_string(101 + i)) == Lnurl::Status::Ok);
+		TEST_ASSERT_EQUAL_STRING(expected.c_str(), urls[i].c_str());
+	}
+#endif
+}
+
+void test_signer_create_lnurl(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	params.defaultDescription = "Üñîçødé & spaces";
+	params.custom["custom1"] = "custom parameter";
+	Lnurl::SigningTemplate t_template;
+	TEST_ASSERT_TRUE(signer.create_template(t_template, params) == Lnurl::Status::Ok);
+	// Same as encoding the signed URL, for both key styles, either case and any nonce length
+	// (the URL doesn't always end on a whole 5-byte word).
+	std::string url, lnurl;
+	size_t length;
+	char output[600];
+	const std::string nonces[] = { "n", "nonce", "nonce 123", "a longer nonce/with?reserved=characters" };
+	for (const bool shorten : { false, true }) {
+		config.shorten = shorten;
+		TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+		TEST_ASSERT_TRUE(signer.create_template(t_template, params) == Lnurl::Status::Ok);
+		for (const std::string &nonce : nonces) {
+			for (const bool uppercase : { false, true }) {
+				TEST_ASSERT_TRUE(signer.create_url(url, params, nonce) == Lnurl::Status::Ok);
+				TEST_ASSERT_TRUE(signer.create_lnurl(lnurl, params, nonce, uppercase) == Lnurl::Status::Ok);
+				TEST_ASSERT_EQUAL_STRING(Lnurl::encode(url, uppercase).c_str(), lnurl.c_str());
+				TEST_ASSERT_TRUE(t_template.create_lnurl(output, length, nonce, uppercase) == Lnurl::Status::Ok);
+				TEST_ASSERT_EQUAL_STRING(lnurl.c_str(), output);
+				TEST_ASSERT_EQUAL(lnurl.size(), length);
+				TEST_ASSERT_TRUE(signer.lnurl_length(length, params, nonce) == Lnurl::Status::Ok);
+				TEST_ASSERT_EQUAL(lnurl.size(), length);
+				TEST_ASSERT_TRUE(t_template.lnurl_length(length, nonce) == Lnurl::Status::Ok);
+				TEST_ASSERT_EQUAL(lnurl.size(), length);
+			}
+		}
+	}
+	// The output needs room for the LNURL and the NUL terminator.
+	TEST_ASSERT_TRUE(signer.lnurl_length(length, params, "nonce") == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(signer.create_lnurl(Span<char>(output, length), length, params, "nonce") == Lnurl::Status::UrlBufferTooSmall);
+	TEST_ASSERT_TRUE(t_template.create_lnurl(Span<char>(output, length), length, "nonce") == Lnurl::Status::UrlBufferTooSmall);
+	TEST_ASSERT_TRUE(signer.create_lnurl(Span<char>(output, length + 1), length, params, "nonce") == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(signer.create_lnurl(lnurl, params, "") == Lnurl::Status::MissingNonce);
+	TEST_ASSERT_TRUE(t_template.create_lnurl(output, length, "") == Lnurl::Status::MissingNonce);
+#ifndef LNURL_NO_EXCEPTIONS
+	TEST_ASSERT_EQUAL_STRING(Lnurl::encode(signer.create_url(params, "nonce")).c_str(), signer.create_lnurl(params, "nonce").c_str());
+#endif
+}
+
+void test_signer_not_configured(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "utf8";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	const std::string nonce = "test";
+	// Neither a default-constructed signer nor one whose config was rejected can sign.
+	Lnurl::Signer signer;
+	for (int i = 0; i < 2; i++) {
+		std::string url;
+		size_t length;
+		char output[600];
+		TEST_ASSERT_TRUE(signer.create_url(url, params, nonce) == Lnurl::Status::NotConfigured);
+		TEST_ASSERT_TRUE(url.empty());
+		TEST_ASSERT_TRUE(signer.url_length(length, params, nonce) == Lnurl::Status::NotConfigured);
+		TEST_ASSERT_TRUE(signer.create_url(output, length, params, nonce) == Lnurl::Status::NotConfigured);
+		TEST_ASSERT_TRUE(signer.create_lnurl(url, params, nonce) == Lnurl::Status::NotConfigured);
+		TEST_ASSERT_TRUE(signer.lnurl_length(length, params, nonce) == Lnurl::Status::NotConfigured);
+		TEST_ASSERT_TRUE(signer.create_lnurl(output, length, params, nonce) == Lnurl::Status::NotConfigured);
+		Lnurl::SigningTemplate t_template;
+		TEST_ASSERT_TRUE(signer.create_template(t_template, params) == Lnurl::Status::NotConfigured);
+		std::vector<std::string> urls;
+		TEST_ASSERT_TRUE(signer.create_urls(urls, { params }, { nonce }) == Lnurl::Status::NotConfigured);
+		TEST_ASSERT_TRUE(signer.create_urls(urls, {}, {}) == Lnurl::Status::NotConfigured);
+	#ifndef LNURL_NO_EXCEPTIONS
+		try {
+			signer.create_url(params, nonce);
+			TEST_FAIL_MESSAGE("Expected exception to be thrown");
+		} catch (const std::invalid_argument &e) {
+			TEST_ASSERT_EQUAL_STRING("Signer is not configured", e.what());
+		}
+		try {
+			signer.create_signature("data");
+			TEST_FAIL_MESSAGE("Expected exception to be thrown");
+		} catch (const std::invalid_argument &e) {
+			TEST_ASSERT_EQUAL_STRING("Signer is not configured", e.what());
+		}
+	#else
+		TEST_ASSERT_TRUE(signer.create_signature("data").empty());
+	#endif
+		TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::UnsupportedKeyEncoding);
+	}
+	config.apiKey.encoding = "hex";
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	std::string url;
+	TEST_ASSERT_TRUE(signer.create_url(url, params, nonce) == Lnurl::Status::Ok);
+}
+
+void test_signer_create_url_encoding(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	config.shorten = false;
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	const std::string nonce = "test_url_encode";
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	// Runs of 15, 16, 17, 31, 32 and 33 safe characters (including all of !'()*-._~), so that
+	// characters to encode come before, at and after the 16-byte blocks which are scanned at once.
+	// Also the characters next to the safe ranges, DEL and UTF-8 bytes.
+	params.defaultDescription = " aZ09!'()*-._~bY&aZ09!'()*-._~bYa=aZ09!'()*-._~bYaZ%aZ09!'()*-._~bYaZ09!'()*-._~bYa\xc3" "\xa9" "aZ09!'()*-._~bYaZ09!'()*-._~bYaZ/:@[`{\x7f" "\x80" "\xff" ",aZ09!'()*-._~bYaZ09!'()*-._~bYaZ0+";
+	params.custom["custom"] = "aZ09!'()*-._~bYaZ09!'()*-._~bYaZ&aZ09!'()*-._~bYa ";
+	const std::string expected = "https://localhost:3000/lnurl?custom=aZ09!'()*-._~bYaZ09!'()*-._~bYaZ%26aZ09!'()*-._~bYa%20&defaultDescription=%20aZ09!'()*-._~bY%26aZ09!'()*-._~bYa%3DaZ09!'()*-._~bYaZ%25aZ09!'()*-._~bYaZ09!'()*-._~bYa%C3%A9aZ09!'()*-._~bYaZ09!'()*-._~bYaZ%2F%3A%40%5B%60%7B%7F%80%FF%2CaZ09!'()*-._~bYaZ09!'()*-._~bYaZ0%2B&id=5d4aeb462a&maxWithdrawable=60000&minWithdrawable=50000&nonce=test_url_encode&signature=cd7234cc912e71c7344451d97c6dd168e4065987170b655103bc74b04a001ae7&tag=withdrawRequest";
+	std::string url;
+	TEST_ASSERT_TRUE(signer.create_url(url, params, nonce) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), url.c_str());
+	char output[512];
+	size_t length;
+	TEST_ASSERT_TRUE(signer.create_url(output, length, params, nonce) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL_STRING(expected.c_str(), output);
+	TEST_ASSERT_EQUAL(expected.size(), length);
+}
+
+void test_sha256_implementations(void) {
+	// Bytes (i * 7 + 3) & 0xff, which repeat every 256 bytes.
+	unsigned char data[1024];
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = (i * 7 + 3) & 0xff;
+	}
+	const struct {
+		size_t length;
+		const char* hash;
+	} vectors[] = {
+		{ 0, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+		{ 3, "6ab0dba1f4f1dfbb37b4f9eeb092c09fca4900ad32bdcd147d8dde35d6c87c35" },
+		{ 55, "e7313d333c272e639f790978283f9eb392e843d0f29b7016828bb1daa4aac70b" },
+		{ 56, "4324d65f3c103567f5589c710bc08f8523f929a9272e3af36fc968e52abc6c27" },
+		{ 63, "81c80242132f230c3bd41b3e63bbcff16107339549214a99614ff26664625055" },
+		{ 64, "39e3d7b6b5d075d37d053ad89b24b41bef4f3c29760c84447cab3f3be1882241" },
+		{ 65, "aacca6ff74fdbb296d165a45cecfa04e5127bc008770fbbdd48006f2d2fae95e" },
+		{ 119, "9ce7368e4daf32341631b492e80359dc9f594b48453cd0dd5bf0b19279cc177e" },
+		{ 120, "7836b787757e95e58b3ca5aec90b1b004e8deba1e50e9675af9cabf1a13a04b5" },
+	};
+	const sha256_implementation::UseImplementation implementations[] = {
+		sha256_implementation::STANDARD,
+		sha256_implementation::USE_SSE4,
+		sha256_implementation::USE_SSE4_AND_AVX2,
+		sha256_implementation::USE_SSE4_AND_SHANI,
+		sha256_implementation::USE_ALL,
+	};
+	// Messages of FinalizeMulti batches, as (offset, length) into data.
+	const size_t messages[9][2] = { { 0, 0 }, { 1, 1 }, { 2, 55 }, { 3, 56 }, { 4, 63 }, { 5, 64 }, { 6, 65 }, { 7, 119 }, { 8, 300 } };
+	const size_t prefixes[] = { 0, 10, 64, 100 };
+	// The hashes of the standard implementation (the first), which the others must match.
+	std::string standard;
+	for (size_t t = 0; t < sizeof(implementations) / sizeof(implementations[0]); t++) {
+		SHA256SelectImplementation(implementations[t]);
+		unsigned char hash[CSHA256::OUTPUT_SIZE];
+		for (const auto &vector : vectors) {
+			CSHA256().Write(data, vector.length).Finalize(hash);
+			TEST_ASSERT_EQUAL_STRING(vector.hash, HexStr(hash).c_str());
+		}
+		// 1 MiB, written in uneven pieces.
+		CSHA256 hasher;
+		for (size_t written = 0; written < (1 << 20);) {
+			const size_t length = std::min<size_t>((1 << 20) - written, 1 + written % 768);
+			hasher.Write(data + written % 256, length);
+			written += length;
+		}
+		hasher.Finalize(hash);
+		TEST_ASSERT_EQUAL_STRING("172c15dc2e12b50e523d8e657cbe7fbb11c1053252bbf1e1431077d57d8128fd", HexStr(hash).c_str());
+		// Batches of 1 to 9 messages after a common prefix, which must equal hashing each one.
+		std::string hashes;
+		const unsigned char* chunks[9];
+		size_t lengths[9];
+		unsigned char multi[9 * CSHA256::OUTPUT_SIZE];
+		for (const size_t prefix : prefixes) {
+			CSHA256 prefixed;
+			prefixed.Write(data + 500, prefix);
+			CHMAC_SHA256 hmac(data + 900, 32);
+			hmac.Write(data + 500, prefix);
+			for (size_t count = 1; count <= 9; count++) {
+				for (size_t i = 0; i < count; i++) {
+					chunks[i] = data + messages[i][0];
+					lengths[i] = messages[i][1];
+				}
+				prefixed.FinalizeMulti(multi, chunks, lengths, count);
+				for (size_t i = 0; i < count; i++) {
+					CSHA256(prefixed).Write(chunks[i], lengths[i]).Finalize(hash);
+					TEST_ASSERT_EQUAL_STRING(HexStr(hash).c_str(), HexStr(Span<const unsigned char>(multi + i * CSHA256::OUTPUT_SIZE, CSHA256::OUTPUT_SIZE)).c_str());
+				}
+				hashes += HexStr(Span<const unsigned char>(multi, count * CSHA256::OUTPUT_SIZE));
+				hmac.FinalizeMulti(multi, chunks, lengths, count);
+				for (size_t i = 0; i < count; i++) {
+					CHMAC_SHA256(hmac).Write(chunks[i], lengths[i]).Finalize(hash);
+					TEST_ASSERT_EQUAL_STRING(HexStr(hash).c_str(), HexStr(Span<const unsigned char>(multi + i * CSHA256::OUTPUT_SIZE, CSHA256::OUTPUT_SIZE)).c_str());
+				}
+				hashes += HexStr(Span<const unsigned char>(multi, count * CSHA256::OUTPUT_SIZE));
+			}
+		}
+		if (t == 0) {
+			standard = hashes;
+		}
+		TEST_ASSERT_EQUAL_STRING(standard.c_str(), hashes.c_str());
+	}
+	SHA256SelectImplementation(sha256_implementation::USE_ALL);
+}
+
+void test_decode_consistency(void) {
+	const std::string url = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+	std::vector<uint8_t> values;
+	ConvertBits<8, 5, true>([&](unsigned char c) { values.push_back(c); }, url.begin(), url.end());
+	const std::vector<std::string> inputs = {
+		Lnurl::encode(url),
+		Lnurl::encode(url, true),
+		// Another prefix.
+		bech32::Encode("lnbc", values),
+		// Padding bits which aren't zero.
+		bech32::Encode("lnurl", { 0, 1 }),
+		// A whole value of padding.
+		bech32::Encode("lnurl", { 0, 0, 0 }),
+	};
+	const bool valid[] = { true, true, false, false, false };
+	const std::vector<Lnurl::DecodeResult> results = Lnurl::decode_batch(inputs);
+	uint8_t buffer[1024];
+	Lnurl::Arena arena(buffer);
+	for (size_t i = 0; i < inputs.size(); i++) {
+		const std::string expected = valid[i] ? url : "";
+		TEST_ASSERT_EQUAL(valid[i], results[i].valid);
+		TEST_ASSERT_EQUAL_STRING(expected.c_str(), results[i].url.c_str());
+		TEST_ASSERT_EQUAL_STRING(expected.c_str(), Lnurl::decode(inputs[i]).c_str());
+		Lnurl::StringView decoded;
+		TEST_ASSERT_TRUE(Lnurl::decode(arena, decoded, inputs[i]) == Lnurl::Status::Ok);
+		TEST_ASSERT_EQUAL_STRING(expected.c_str(), std::string(decoded.data(), decoded.size()).c_str());
+		arena.reset();
+		Lnurl::Decoder decoder;
+		char output[Lnurl::Decoder::max_output(256)];
+		size_t length;
+		TEST_ASSERT_TRUE(decoder.update(inputs[i], output, length) == Lnurl::Status::Ok);
+		TEST_ASSERT_EQUAL(valid[i], decoder.finish());
+	}
+}
+
+void test_pregenerator_errors(void) {
+	Lnurl::SignerConfig config;
+	config.apiKey.id = "5d4aeb462a";
+	config.apiKey.key = "ef9901bebc801518e7d862c2edaedd3acd86ec132fb3bd5ac0013c9a5ba478db";
+	config.apiKey.encoding = "hex";
+	config.callbackUrl = "https://localhost:3000/lnurl";
+	Lnurl::Signer signer;
+	TEST_ASSERT_TRUE(signer.set_config(config) == Lnurl::Status::Ok);
+	Lnurl::WithdrawParams params;
+	params.minWithdrawable = "50000";
+	params.maxWithdrawable = "60000";
+	// After 2 nonces, the generator writes past the length it was given.
+	std::atomic<unsigned int> counter{0};
+	const auto nonceGenerator = [&counter](Span<char> nonce) -> size_t {
+		std::fill(nonce.begin(), nonce.end(), 'n');
+		return ++counter > 2 ? nonce.size() + 1 : nonce.size();
+	};
+	Lnurl::Pregenerator pregenerator;
+	TEST_ASSERT_TRUE(pregenerator.status() == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(pregenerator.init(Lnurl::Signer(), params, 3, 10, nonceGenerator) == Lnurl::Status::NotConfigured);
+	TEST_ASSERT_TRUE(pregenerator.status() == Lnurl::Status::NotConfigured);
+	TEST_ASSERT_EQUAL(0, pregenerator.fill());
+	TEST_ASSERT_TRUE(pregenerator.init(signer, params, 3, 10, nonceGenerator) == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(pregenerator.status() == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL(2, pregenerator.fill());
+	TEST_ASSERT_TRUE(pregenerator.status() == Lnurl::Status::NonceTooLong);
+	// The error is kept until init().
+	counter = 0;
+	pregenerator.pop();
+	TEST_ASSERT_EQUAL(0, pregenerator.fill());
+	TEST_ASSERT_FALSE(pregenerator.start(1));
+	TEST_ASSERT_TRUE(pregenerator.init(signer, params, 3, 10, nonceGenerator) == Lnurl::Status::Ok);
+	TEST_ASSERT_EQUAL(0, pregenerator.size());
+#ifdef LNURL_THREADS
+	// The background task stops on the error.
+	TEST_ASSERT_TRUE(pregenerator.start(1));
+	TEST_ASSERT_TRUE(pregenerator.init(signer, params, 3, 10, nonceGenerator) == Lnurl::Status::PregeneratorRunning);
+	while (pregenerator.status() == Lnurl::Status::Ok) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	TEST_ASSERT_TRUE(pregenerator.status() == Lnurl::Status::NonceTooLong);
+	TEST_ASSERT_EQUAL(2, pregenerator.size());
+	counter = 0;
+	TEST_ASSERT_TRUE(pregenerator.init(signer, params, 3, 10, nonceGenerator) == Lnurl::Status::Ok);
+	TEST_ASSERT_TRUE(pregenerator.start(1));
+	pregenerator.stop();
+#endif
 }
 
 // {{SIGNER_TESTS}}
@@ -169,6 +1429,38 @@ int main(void) {
 	RUN_TEST(test_signer_create_url_withdraw_minWithdrawable_lt_zero);
 	RUN_TEST(test_signer_create_url_withdraw_maxWithdrawable_lt_minWithdrawable);
 	RUN_TEST(test_signer_create_url_custom_params_reserved);
+	RUN_TEST(test_create_signature_reuse_signer);
+	RUN_TEST(test_signer_create_url_buffer);
+	RUN_TEST(test_signer_create_url_buffer_too_small);
+	RUN_TEST(test_signer_create_urls);
+	RUN_TEST(test_hmac_sha256_finalize_multi);
+	RUN_TEST(test_amount);
+	RUN_TEST(test_signer_create_url_withdraw_amount_not_a_number);
+	RUN_TEST(test_signer_create_url_withdraw_amount_exact);
+	RUN_TEST(test_signer_create_url_flat_query);
+	RUN_TEST(test_signer_create_url_matches_query);
+	RUN_TEST(test_sha256_midstate);
+	RUN_TEST(test_signer_create_template);
+	RUN_TEST(test_bech32_span);
+	RUN_TEST(test_bech32_checksum);
+	RUN_TEST(test_encode_decode_lengths);
+	RUN_TEST(test_encode_uppercase);
+	RUN_TEST(test_qrcode);
+	RUN_TEST(test_decoder_chunks);
+	RUN_TEST(test_decode_batch);
+	RUN_TEST(test_convert_bits_kernels);
+	RUN_TEST(test_hex_codec);
+	RUN_TEST(test_status_codes);
+	RUN_TEST(test_string_view);
+	RUN_TEST(test_arena);
+	RUN_TEST(test_signer_shared_between_threads);
+	RUN_TEST(test_pregenerator);
+	RUN_TEST(test_signer_create_lnurl);
+	RUN_TEST(test_signer_not_configured);
+	RUN_TEST(test_signer_create_url_encoding);
+	RUN_TEST(test_sha256_implementations);
+	RUN_TEST(test_decode_consistency);
+	RUN_TEST(test_pregenerator_errors);
 // {{SIGNER_RUN_TESTS}}
 	return UNITY_END();
 }